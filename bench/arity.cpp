@@ -0,0 +1,148 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* arity: the cost of calling tabulate() with many distinct column counts.
+ *
+ * Every call site below passes a different number of columns, 1 to ARITIES,
+ * to the variadic tabulate(). Built as is, each of them is a thin shim over
+ * the one non-template layout loop of the library. Built with -DLEGACY, each
+ * of them instead gets its own copy of the loop, as tabulate() had before the
+ * loop was moved out of the template. Compare the build time and the size of
+ * the code of the two builds; their output is the same.
+ *
+ * Build:	time c++ -std=c++11 -O2 -o arity arity.cpp
+ * 		time c++ -std=c++11 -O2 -DLEGACY -o arity-legacy arity.cpp
+ * Compare:	size arity arity-legacy
+ * 		./arity | cmp - <(./arity-legacy)
+ *
+ * 	-DARITIES=N	the number of call sites (64 by default)
+ */
+
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../tabulator/tabulator.h"
+
+#ifndef ARITIES
+#define ARITIES 64
+#endif
+
+using tabulator::column;
+
+template <size_t... I>
+struct indices {};
+
+template <size_t N, size_t... I>
+struct make_indices : make_indices<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct make_indices<0, I...> { using type = indices<I...>; };
+
+namespace bench {
+
+#ifdef LEGACY
+
+using namespace tabulator::internal;
+
+template <size_t N>
+inline bool is_unconsumed(const std::array<colstate,N>& state, const std::array<column,N>& c)
+{
+	for (size_t i = 0; i < N; ++i)
+		if (!is_generated(c[i]) && !state[i].end(c[i]))
+			return true;
+	return false;
+}
+
+// The layout loop instantiated for every number of columns
+template <typename... Cols>
+inline std::ostream& tabulate(std::ostream& os, const char *sep, char fill, const Cols&... cols)
+{
+	std::array<colstate,sizeof...(cols)> state;
+	const std::array<column,sizeof...(cols)> c{ cols... };
+	const size_t seplen = std::strlen(sep);
+	ostream_sink out{os};
+
+	for (bool unconsumed = is_unconsumed(state, c); unconsumed; unconsumed = is_unconsumed(state, c)) {
+		for (size_t col = 0; col < sizeof...(cols); ++col) {
+			const span line = next_span(state[col], c[col]);
+			column::cursor at = state[col].at;
+
+			emit_span(out, c[col], line, state[col].ln, at);
+			if ((col + 1) < sizeof...(cols))
+				switch_col(out, state[col].lp, c[col].width, fill, sep, seplen);
+			state[col].breakLine();
+		}
+		out.newline();
+	}
+
+	return os;
+}
+
+#else
+
+using tabulator::tabulate;
+
+#endif
+
+}
+
+template <size_t... I>
+void call_site(std::ostream& os, const column *pool, indices<I...>)
+{
+	bench::tabulate(os, " | ", ' ', pool[I]...);
+}
+
+// Instantiates and calls the call sites of "n" down to 1 columns
+template <size_t N>
+struct sites {
+	static void run(std::ostream& os, const column *pool)
+	{
+		call_site(os, pool, typename make_indices<N>::type{});
+		sites<N - 1>::run(os, pool);
+	}
+};
+
+template <>
+struct sites<0> {
+	static void run(std::ostream&, const column *) {}
+};
+
+int main()
+{
+	std::vector<std::string> texts;
+	std::vector<column> pool;
+
+	for (size_t i = 0; i < ARITIES; ++i) {
+		texts.push_back("column " + std::to_string(i) + " of the widest table, wrapped to fit");
+		texts.back().append(i % 7, '!');
+	}
+	for (size_t i = 0; i < ARITIES; ++i)
+		pool.push_back(column{texts[i], 8 + i % 5});
+
+	sites<ARITIES>::run(std::cout, pool.data());
+	return 0;
+}
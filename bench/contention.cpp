@@ -0,0 +1,153 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* contention: threads rendering tables into one shared destination.
+ *
+ * 1 to 64 threads render the same table over and over, all of them into one
+ * of three destinations:
+ *
+ * 	ostream	std::cout, synchronized with stdio, each line a write()
+ * 	locked	a locked_buffer, which the main thread keeps emptying
+ * 	log	a log_buffer, until it is full or the time is up
+ *
+ * For each, the aggregate throughput in lines per second is reported, with
+ * two measures of fairness over the lines rendered by each thread: Jain's
+ * index, (sum x)^2 / (n * sum x^2), which is 1 when all threads did the same
+ * amount of work and 1/n when one did it all, and the ratio of the fewest
+ * lines to the most. The report goes to the standard error.
+ *
+ * Build:	c++ -std=c++11 -O2 -pthread -o contention contention.cpp
+ * Usage:	contention [MILLISECONDS [MEGABYTES]] >/dev/null
+ *
+ * 	MILLISECONDS	how long each run lasts (200 by default)
+ * 	MEGABYTES	the capacity of the log_buffer (512 by default)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../tabulator/shared.h"
+
+using namespace tabulator;
+using clock_type = std::chrono::steady_clock;
+
+enum mode { to_ostream, to_locked, to_log };
+
+static const char *const mode_names[] = { "ostream", "locked", "log" };
+
+struct run {
+	std::vector<unsigned long long> lines; // rendered by each thread
+	double seconds;
+};
+
+static const char text[] =
+	"Threads render this table into one shared destination, a line at a "
+	"time, and the benchmark counts the lines each of them gets through.";
+
+// Renders the table into its sink of "m" until told to stop
+static void worker(mode m, locked_buffer& locked, log_buffer& log, const std::atomic<bool>& go,
+		const std::atomic<bool>& stop, unsigned long long& lines)
+{
+	const layout table{column{text, 24}, column{"2026-10-18 12:00:00", 10}, column{text, 40}};
+	internal::ostream_sink os{std::cout};
+	locked_buffer::writer lw{locked};
+	log_buffer::writer gw{log};
+	sink& out = m == to_ostream ? static_cast<sink&>(os) : m == to_locked ? static_cast<sink&>(lw) : gw;
+	unsigned long long n = 0;
+
+	while (!go.load(std::memory_order_acquire))
+		std::this_thread::yield();
+	while (!stop.load(std::memory_order_relaxed)) {
+		table.render(out, " | ", ' ');
+		n += table.size();
+	}
+	lines = n;
+}
+
+static run measure(mode m, size_t threads, std::chrono::milliseconds time, log_buffer& log)
+{
+	locked_buffer locked;
+	std::string taken;
+	std::atomic<bool> go{false}, stop{false};
+	std::vector<std::thread> pool;
+	run r;
+
+	log.clear();
+	r.lines.resize(threads);
+	for (size_t i = 0; i < threads; ++i)
+		pool.emplace_back(worker, m, std::ref(locked), std::ref(log), std::cref(go), std::cref(stop),
+				std::ref(r.lines[i]));
+
+	const clock_type::time_point start = clock_type::now();
+
+	go.store(true, std::memory_order_release);
+	while (clock_type::now() - start < time && !log.lost()) {
+		std::this_thread::sleep_for(std::chrono::milliseconds{1});
+		if (m == to_locked)
+			locked.take(taken);
+	}
+	stop.store(true);
+	for (std::thread& t : pool)
+		t.join();
+	r.seconds = std::chrono::duration<double>(clock_type::now() - start).count();
+	return r;
+}
+
+int main(int argc, char *argv[])
+{
+	const std::chrono::milliseconds time{argc > 1 ? std::atol(argv[1]) : 200};
+	const size_t megabytes = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 512;
+	log_buffer log{megabytes << 20};
+
+	tabulate(std::cerr, " ", ' ', column{"threads", 7}, column{"sink", 7}, column{"Mlines/s", 8},
+			column{"Jain", 5}, column{"min/max", 7});
+	for (size_t threads = 1; threads <= 64; threads *= 2)
+		for (mode m : { to_ostream, to_locked, to_log }) {
+			const run r = measure(m, threads, time, log);
+			unsigned long long sum = 0, least = ~0ULL, most = 0;
+			double squares = 0;
+			char cells[3][16];
+
+			for (unsigned long long n : r.lines) {
+				sum += n;
+				squares += static_cast<double>(n) * static_cast<double>(n);
+				least = n < least ? n : least;
+				most = n > most ? n : most;
+			}
+			std::snprintf(cells[0], sizeof(cells[0]), "%.2f", static_cast<double>(sum) / r.seconds / 1e6);
+			std::snprintf(cells[1], sizeof(cells[1]), "%.3f",
+					squares ? static_cast<double>(sum) * static_cast<double>(sum) / (static_cast<double>(threads) * squares) : 0);
+			std::snprintf(cells[2], sizeof(cells[2]), "%.3f", most ? static_cast<double>(least) / static_cast<double>(most) : 0);
+			tabulate(std::cerr, " ", ' ', column{std::to_string(threads), 7}, column{mode_names[m], 7},
+					column{cells[0], 8}, column{cells[1], 5}, column{cells[2], 7});
+		}
+	return 0;
+}
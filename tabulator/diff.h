@@ -0,0 +1,346 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TABULATOR_DIFF_H_
+#define TABULATOR_DIFF_H_
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tabulator.h"
+
+namespace tabulator {
+
+namespace internal {
+
+struct text_line {
+	const char *p;
+	size_t n;
+};
+
+struct line_hash {
+	inline size_t operator()(const text_line& l) const
+	{
+		// FNV-1a
+		size_t h = static_cast<size_t>(14695981039346656037ULL);
+		for (size_t i = 0; i < l.n; ++i)
+			h = (h ^ static_cast<unsigned char>(l.p[i])) * static_cast<size_t>(1099511628211ULL);
+		return h;
+	}
+};
+
+struct line_eq {
+	inline bool operator()(const text_line& a, const text_line& b) const
+	{
+		return a.n == b.n && !std::memcmp(a.p, b.p, a.n);
+	}
+};
+
+inline std::vector<text_line> split_lines(const char *p, size_t n)
+{
+	std::vector<text_line> lines;
+
+	for (size_t i = 0; i < n; ) {
+		const char *eol = static_cast<const char *>(std::memchr(p + i, '\n', n - i));
+		const size_t len = eol ? static_cast<size_t>(eol - (p + i)) : n - i;
+
+		lines.push_back(text_line{p + i, len});
+		i += len + 1;
+	}
+	return lines;
+}
+
+// A line deleted from the old text at "from", or a line inserted from the
+// new text at "to" before the line "from" of the old one.
+struct edit {
+	bool insert;
+	size_t from;
+	size_t to;
+};
+
+// Myers' O(ND) difference algorithm, linear space variant: finds the middle
+// snake of the shortest edit script with forward and backward searches that
+// meet, and recurses on both sides of it. Lines are compared as numbers.
+// Like in GNU diff, a search that takes more than about the square root of the
+// number of lines, and at least "cheap" steps, gives up on the shortest
+// script: the texts are split at the point furthest from its start that
+// either search has reached, which bounds the work per split to O(N + M)
+// times the cutoff.
+class myers {
+	const size_t * const a;
+	const size_t * const b;
+	std::vector<long> g, p;
+	std::vector<edit>& out;
+	long limit{1};
+
+	enum : long { cheap = 256 };
+
+	static inline size_t mod(long k, long z) { return static_cast<size_t>(((k % z) + z) % z); }
+
+	// Recurses on both sides of the furthest point the searches reached in
+	// "h" steps, if it is inside the texts
+	inline bool split(long i, long N, long j, long M, long h)
+	{
+		const long Z = 2 * (N < M ? N : M) + 2;
+		const long kmin = -(h - 2 * (h > M ? h - M : 0)), kmax = h - 2 * (h > N ? h - N : 0);
+		long best = -1, sx = 0, sy = 0;
+
+		for (long o = 1; o >= 0; --o) {
+			const std::vector<long>& c = o ? g : p;
+
+			for (long k = kmin; k <= kmax; k += 2) {
+				const long x = c[mod(k, Z)], y = x - k;
+
+				if (x >= 0 && y >= 0 && x <= N && y <= M && x + y > best) {
+					best = x + y;
+					sx = o ? x : N - x;
+					sy = o ? y : M - y;
+				}
+			}
+		}
+		if ((!sx && !sy) || (sx == N && sy == M))
+			return false;
+		run(i, sx, j, sy);
+		run(i + sx, N - sx, j + sy, M - sy);
+		return true;
+	}
+
+public:
+	inline myers(const size_t *from, const size_t *to, size_t N, size_t M, std::vector<edit>& edits)
+		: a{from}, b{to}, g(2 * (N < M ? N : M) + 2), p(2 * (N < M ? N : M) + 2), out(edits)
+	{
+		for (size_t n = N + M + 3; n; n >>= 2)
+			limit <<= 1;
+		limit = limit < cheap ? cheap : limit;
+	}
+
+	inline void run(long i, long N, long j, long M)
+	{
+		if (N > 0 && M > 0) {
+			const long w = N - M, L = N + M, Z = 2 * (N < M ? N : M) + 2;
+
+			std::fill(g.begin(), g.begin() + Z, 0);
+			std::fill(p.begin(), p.begin() + Z, 0);
+			for (long h = 0; h <= L / 2 + L % 2; ++h) {
+				for (long o = 1; o >= 0; --o) {
+					std::vector<long>& c = o ? g : p;
+					const std::vector<long>& d = o ? p : g;
+					const long kmin = -(h - 2 * (h > M ? h - M : 0));
+					const long kmax = h - 2 * (h > N ? h - N : 0);
+
+					for (long k = kmin; k <= kmax; k += 2) {
+						long x = (k == -h || (k != h && c[mod(k - 1, Z)] < c[mod(k + 1, Z)]))
+								? c[mod(k + 1, Z)] : c[mod(k - 1, Z)] + 1;
+						long y = x - k;
+						const long s = x, t = y;
+
+						while (x < N && y < M && a[i + (o ? x : N - x - 1)] == b[j + (o ? y : M - y - 1)])
+							++x, ++y;
+						c[mod(k, Z)] = x;
+
+						const long z = w - k;
+						if (L % 2 != o || z < -(h - o) || z > h - o || c[mod(k, Z)] + d[mod(z, Z)] < N)
+							continue;
+
+						const long D = o ? 2 * h - 1 : 2 * h;
+						const long x0 = o ? s : N - x, y0 = o ? t : M - y;
+						const long u = o ? x : N - s, v = o ? y : M - t;
+
+						if (D > 1 || (x0 != u && y0 != v)) {
+							run(i, x0, j, y0);
+							run(i + u, N - u, j + v, M - v);
+						} else if (M > N) {
+							run(i + N, 0, j + N, M - N);
+						} else if (M < N) {
+							run(i + M, N - M, j + M, 0);
+						}
+						return;
+					}
+				}
+				if (h >= limit && split(i, N, j, M, h))
+					return;
+			}
+		} else if (N > 0) {
+			for (long n = 0; n < N; ++n)
+				out.push_back(edit{false, static_cast<size_t>(i + n), 0});
+		} else {
+			for (long n = 0; n < M; ++n)
+				out.push_back(edit{true, static_cast<size_t>(i), static_cast<size_t>(j + n)});
+		}
+	}
+};
+
+inline std::vector<edit> diff_lines(const std::vector<text_line>& from, const std::vector<text_line>& to)
+{
+	std::unordered_map<text_line, size_t, line_hash, line_eq> ids;
+	std::vector<size_t> a, b;
+	std::vector<edit> edits;
+
+	// Equal lines get equal numbers, so that the search compares numbers
+	a.reserve(from.size());
+	for (const auto& l : from)
+		a.push_back(ids.emplace(l, ids.size()).first->second);
+	b.reserve(to.size());
+	for (const auto& l : to)
+		b.push_back(ids.emplace(l, ids.size()).first->second);
+
+	// Common head and tail are not part of any edit
+	size_t head = 0, tail = 0;
+	while (head < a.size() && head < b.size() && a[head] == b[head])
+		++head;
+	while (tail < a.size() - head && tail < b.size() - head && a[a.size() - tail - 1] == b[b.size() - tail - 1])
+		++tail;
+
+	// A line that is only in one of the texts is an edit whatever the rest
+	// is, so, as in GNU diff, only the others are searched
+	std::vector<unsigned char> in(ids.size());
+	std::vector<size_t> ka, kb, xa, xb; // indices and numbers of the kept lines
+	for (size_t i = head; i < a.size() - tail; ++i)
+		in[a[i]] |= 1;
+	for (size_t j = head; j < b.size() - tail; ++j)
+		in[b[j]] |= 2;
+	for (size_t i = head; i < a.size() - tail; ++i)
+		if (in[a[i]] == 3) {
+			ka.push_back(i);
+			xa.push_back(a[i]);
+		}
+	for (size_t j = head; j < b.size() - tail; ++j)
+		if (in[b[j]] == 3) {
+			kb.push_back(j);
+			xb.push_back(b[j]);
+		}
+
+	std::vector<edit> kept;
+	myers{xa.data(), xb.data(), xa.size(), xb.size(), kept}.run(0, static_cast<long>(xa.size()),
+			0, static_cast<long>(xb.size()));
+
+	// The lines of the two texts between the kept lines that are left equal
+	// are deleted and inserted
+	size_t i = head, j = head;
+	auto edit_to = [&](size_t ia, size_t jb) {
+		for (; i < ia; ++i)
+			edits.push_back(edit{false, i, 0});
+		for (; j < jb; ++j)
+			edits.push_back(edit{true, ia, j});
+	};
+	for (size_t x = 0, y = 0, e = 0; x < xa.size() && y < xb.size(); ) {
+		if (e < kept.size() && kept[e].from == x) {
+			(kept[e++].insert ? y : x)++;
+		} else {
+			edit_to(ka[x], kb[y]);
+			++i, ++j, ++x, ++y;
+		}
+	}
+	edit_to(a.size() - tail, b.size() - tail);
+	return edits;
+}
+
+}
+
+/** Output two texts side by side, aligned line by line to show their difference.
+ *
+ * Computes a line-level edit script that turns the "from" text into the "to"
+ * one with Myers' O(ND) algorithm, in its linear space variant, and outputs
+ * the old lines on the left and the new ones on the right in columns of the
+ * given width, with a marker in between in the manner of sdiff: " " for
+ * equal lines, "|" for changed ones, "<" for the lines only in "from" and ">"
+ * for the lines only in "to".
+ *
+ * Lines that occur in only one of the texts are set aside before the search.
+ * The script is the shortest one unless the texts differ almost everywhere:
+ * then, like GNU diff, the search stops early and settles for a longer
+ * script rather than taking time quadratic in the number of lines.
+ *
+ * @param os		an ostream object to output text into
+ * @param from		the old text
+ * @param to		the new text
+ * @param width		the width of each of the two text columns
+ * @param where		how to clip lines longer than "width"; by default they
+ *             		are wrapped
+ *
+ * Example:
+ * @code
+ *
+ * 	#include "diff.h"
+ *
+ * 	tabulator::tabulate_diff(std::cout, old_config, new_config, 60);
+ *
+ * @endcode
+ *
+ * @return Reference to the stream, so that it could be used later in the same
+ * expression that has called the function.
+ */
+inline std::ostream& tabulate_diff(std::ostream& os, const std::string& from, const std::string& to, std::size_t width,
+		ellipsis where = ellipsis::none)
+{
+	using namespace internal;
+
+	const std::vector<text_line> a = split_lines(from.data(), from.size());
+	const std::vector<text_line> b = split_lines(to.data(), to.size());
+	const std::vector<edit> edits = diff_lines(a, b);
+	ostream_sink out{os};
+	size_t i = 0, j = 0;
+
+	auto row = [&](const text_line *l, const char *marker, const text_line *r) {
+		const column c[] = {
+			column{l ? l->p : "", l ? l->n : 0, width}.truncate(where),
+			column{marker, 1},
+			column{r ? r->p : "", r ? r->n : 0, width}.truncate(where),
+		};
+		colstate state[3];
+
+		render(out, " ", ' ', c, state, 3);
+	};
+
+	// Equal lines up to the next edit, then a hunk of deleted and inserted
+	// lines, paired up while there are both
+	for (size_t e = 0;;) {
+		const size_t stop = e < edits.size() ? edits[e].from : a.size();
+
+		for (; i < stop; ++i, ++j)
+			row(&a[i], " ", &b[j]);
+
+		// Deletes and inserts at the hunk may come in any order
+		size_t dels = 0, ins = 0;
+		for (; e < edits.size() && edits[e].from == i + dels; ++e)
+			++(edits[e].insert ? ins : dels);
+		for (size_t k = 0; k < dels || k < ins; ++k)
+			row(k < dels ? &a[i + k] : nullptr, k < dels && k < ins ? "|" : k < dels ? "<" : ">",
+					k < ins ? &b[j + k] : nullptr);
+		i += dels;
+		j += ins;
+		if (e == edits.size() && i == a.size())
+			break;
+	}
+
+	return os;
+}
+
+}
+
+#endif /* TABULATOR_DIFF_H_ */
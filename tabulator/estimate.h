@@ -0,0 +1,206 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TABULATOR_ESTIMATE_H_
+#define TABULATOR_ESTIMATE_H_
+
+#include <cmath>
+#include <vector>
+
+#include "tabulator.h"
+
+namespace tabulator {
+
+namespace internal {
+
+// Lines and bytes of a sample of a text laid out in a column. A sample starts
+// on the line after the first hard newline of its block, if there is one,
+// where the layout is the same as in the whole text, and ends on the first
+// line that ends past the block.
+struct sample_lines {
+	size_t at, lines, bytes;
+};
+
+inline sample_lines sample(const column& c, size_t from, size_t to)
+{
+	colstate state;
+	size_t lines = 0;
+
+	for (state.cp = from; state.cp < to && c.at(state.cp, state.at) != '\n'; ++state.cp)
+		;
+	state.cp = state.cp < to ? state.cp + 1 : from;
+	state.ln = 1;
+	from = state.cp;
+	for (; state.cp < to; state.breakLine(), ++lines)
+		next_span(state, c);
+	return sample_lines{from, lines, state.cp - from};
+}
+
+}
+
+/** Estimate how many lines tabulate() would output for a long column.
+ *
+ * Blocks of the text spread evenly over it are laid out, and the number of
+ * lines is estimated from the lines per byte in them, with a bound on the
+ * error worked out from how much the blocks differ. Construction thus takes
+ * the time to lay out "samples" blocks, whatever the length of the text.
+ *
+ * The estimate is then refined by counting the lines exactly from the start
+ * of the text on, a given number of bytes per call to refine(), e.g. when
+ * the program is idle. The counted part is exact; only the rest is estimated,
+ * so the error shrinks to zero as the count goes on. Short texts, and columns
+ * that are truncated or limited to a number of lines, are counted exactly
+ * at once.
+ *
+ * The text must outlive the estimate.
+ *
+ * Example:
+ * @code
+ *
+ * 	#include "estimate.h"
+ *
+ * 	tabulator::line_estimate total{column{text.data(), text.size(), 80}};
+ *
+ * 	scrollbar.range(total.lines(), total.error());
+ * 	while (!total.exact() && idle())
+ * 		if (total.refine(1 << 20))
+ * 			scrollbar.range(total.lines(), 0);
+ *
+ * @endcode
+ */
+class line_estimate {
+	const column c;
+	internal::colstate done; // where the exact count has got to
+	std::size_t counted{0};  // lines up to there
+	std::vector<internal::sample_lines> samples;
+
+	// Sums over the samples from a point of the text on
+	struct sums {
+		double k{0}, b{0}, l{0}, bb{0}, ll{0}, bl{0};
+	};
+
+	inline sums over(std::size_t from) const
+	{
+		sums s;
+
+		for (const auto& x : samples) {
+			const double b = static_cast<double>(x.bytes), l = static_cast<double>(x.lines);
+
+			if (x.at < from)
+				continue;
+			s.k += 1;
+			s.b += b;
+			s.l += l;
+			s.bb += b * b;
+			s.ll += l * l;
+			s.bl += b * l;
+		}
+		return s;
+	}
+
+	// The samples of the text not counted yet, or all if none are left
+	inline sums rest(void) const
+	{
+		const sums s = over(done.cp);
+
+		return s.k > 0 ? s : over(0);
+	}
+
+public:
+	/** Sample a column.
+	 *
+	 * @param col		the column
+	 * @param n		the number of blocks to lay out
+	 * @param block		the size of a block in bytes
+	 */
+	inline explicit line_estimate(const column& col, std::size_t n = 32, std::size_t block = 16384) : c{col}
+	{
+		if (internal::is_generated(c)) {
+			done.cp = c.size; // no lines of its own
+			return;
+		}
+		if (c.trunc != ellipsis::none || c.maxlines || c.size <= n * block || n < 2) {
+			refine(c.size);
+			return;
+		}
+
+		const std::size_t stride = c.size / n;
+		for (std::size_t i = 0; i < n; ++i) {
+			const internal::sample_lines s = internal::sample(c, i * stride, i * stride + block);
+
+			if (s.bytes)
+				samples.push_back(s);
+		}
+	}
+
+	/** Whether the lines have all been counted. */
+	inline bool exact(void) const { return done.end(c); }
+
+	/** The estimated number of lines. */
+	inline std::size_t lines(void) const
+	{
+		const sums s = rest();
+
+		return counted + (s.b > 0 ? static_cast<std::size_t>(std::llround(s.l / s.b * static_cast<double>(c.size - done.cp))) : 0);
+	}
+
+	/** The bound on the error of lines(): the number of lines is within
+	 * it of lines() with a 95% confidence, and exactly lines() when it is
+	 * zero. */
+	inline std::size_t error(void) const
+	{
+		const std::size_t left = c.size - done.cp;
+		const sums s = over(done.cp);
+
+		if (exact())
+			return 0;
+		if (s.k < 2)
+			return left;
+
+		// The variance of a ratio estimator over the sampled blocks
+		const double r = s.l / s.b, mean = s.b / s.k, share = s.b / static_cast<double>(left);
+		const double resid = s.ll - 2 * r * s.bl + r * r * s.bb;
+		const double var = (share < 1 ? 1 - share : 0) * (resid > 0 ? resid : 0) / (s.k - 1) / (s.k * mean * mean);
+		const double bound = std::ceil(2 * static_cast<double>(left) * std::sqrt(var));
+
+		return bound < static_cast<double>(left) ? static_cast<std::size_t>(bound) : left;
+	}
+
+	/** Count the lines of about "n" more bytes of the text exactly.
+	 *
+	 * @return Whether the count is exact now.
+	 */
+	inline bool refine(std::size_t n)
+	{
+		const std::size_t to = n < c.size - done.cp ? done.cp + n : c.size;
+
+		for (; done.cp < to; done.breakLine(), ++counted)
+			internal::next_span(done, c);
+		return exact();
+	}
+};
+
+}
+
+#endif /* TABULATOR_ESTIMATE_H_ */
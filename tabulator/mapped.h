@@ -0,0 +1,187 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TABULATOR_MAPPED_H_
+#define TABULATOR_MAPPED_H_
+
+/* Memory-mapped layout files. Needs POSIX mmap(). */
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "packed.h"
+
+namespace tabulator {
+
+/** A layout read from a file saved by packed_layout::save(), without laying anything out.
+ *
+ * The file is mapped into memory and rendered from directly, so a process
+ * that shows the same texts as an earlier one skips the layout pass
+ * completely. Every column is checked against the file by a hash of its text
+ * and all its settings, and the lines of every column are decoded once to
+ * check that they are all inside its text; if the file is missing, damaged
+ * or has been made for other columns, the mapped layout is not valid and the
+ * columns have to be laid out anew. The check reads a couple of bytes per
+ * line, much less than laying the texts out. The column texts must outlive
+ * the mapped layout.
+ *
+ * Example:
+ * @code
+ *
+ * 	#include "mapped.h"
+ *
+ * 	const column cols[] = { column::numbers(1, 8), column{archived_log, 100} };
+ * 	tabulator::mapped_layout cached{"log.layout", cols, 2};
+ *
+ * 	if (cached)
+ * 		cached.render(std::cout, " ", ' ');
+ * 	else
+ * 		tabulator::packed_layout{cols, 2}.save("log.layout");
+ *
+ * @endcode
+ */
+class mapped_layout {
+	std::vector<column> c;
+	void *map{MAP_FAILED};
+	std::size_t mapsize{0};
+	std::vector<internal::packed_spans> cols;
+	std::vector<std::size_t> lines;
+	std::size_t height{0};
+
+	inline bool check(const internal::layout_record& r, std::uint64_t key) const
+	{
+		// Every span takes two bytes at least
+		return r.key == key && r.lines <= r.bytes / 2
+			&& r.anchors == r.lines / internal::pack_block + (r.lines % internal::pack_block != 0)
+			&& r.anchors_at % 8 == 0
+			&& r.anchors_at <= mapsize && r.anchors <= (mapsize - r.anchors_at) / sizeof(internal::anchor)
+			&& r.bytes_at <= mapsize && r.bytes <= mapsize - r.bytes_at;
+	}
+
+	inline bool open(const std::string& path)
+	{
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		struct stat st;
+
+		if (fd < 0)
+			return false;
+		if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+			mapsize = static_cast<std::size_t>(st.st_size);
+			map = ::mmap(nullptr, mapsize, PROT_READ, MAP_SHARED, fd, 0);
+		}
+		::close(fd);
+		if (map == MAP_FAILED || mapsize < sizeof(internal::layout_header))
+			return false;
+
+		const char *base = static_cast<const char *>(map);
+		const auto *head = reinterpret_cast<const internal::layout_header *>(base);
+		const std::size_t n = c.size();
+
+		if (std::memcmp(head->magic, internal::layout_magic, sizeof head->magic) || head->columns != n
+				|| (mapsize - sizeof *head) / sizeof(internal::layout_record) < n)
+			return false;
+
+		const auto *recs = reinterpret_cast<const internal::layout_record *>(base + sizeof *head);
+		for (std::size_t col = 0; col < n; ++col) {
+			if (!check(recs[col], internal::column_key(c[col])))
+				return false;
+			cols.push_back(internal::packed_spans{
+				reinterpret_cast<const unsigned char *>(base + recs[col].bytes_at),
+				static_cast<std::size_t>(recs[col].bytes),
+				reinterpret_cast<const internal::anchor *>(base + recs[col].anchors_at),
+				static_cast<std::size_t>(recs[col].lines)});
+			if (!internal::check_spans(cols.back(), c[col]))
+				return false;
+			lines.push_back(static_cast<std::size_t>(recs[col].lines));
+		}
+		height = internal::row_height(lines.data(), n);
+		return height == head->height;
+	}
+
+public:
+	/** Map the layout file for "n" columns; see valid() for the result. */
+	inline mapped_layout(const std::string& path, const column *columns, std::size_t n)
+	{
+		for (std::size_t col = 0; col < n; ++col)
+			c.push_back(columns[col]);
+		if (!open(path)) {
+			cols.clear();
+			lines.clear();
+			height = 0;
+		}
+	}
+	template <typename... Cols, internal::force_type<column, Cols...> = 0>
+	inline explicit mapped_layout(const std::string& path, const Cols&... columns)
+		: mapped_layout(path, std::array<column,sizeof...(columns)>{ {columns...} }.data(), sizeof...(columns)) {}
+	inline mapped_layout(const mapped_layout&) = delete;
+	inline ~mapped_layout()
+	{
+		if (map != MAP_FAILED)
+			::munmap(map, mapsize);
+	}
+
+	/** Whether the file has been mapped and matches the columns. */
+	inline bool valid(void) const { return cols.size() == c.size() && !c.empty(); }
+	inline explicit operator bool(void) const { return valid(); }
+
+	/** The number of columns. */
+	inline std::size_t columns(void) const { return c.size(); }
+
+	/** The number of output lines. */
+	inline std::size_t size(void) const { return height; }
+
+	/** Output lines [from, to) into a sink, by default all of them. */
+	inline void render(sink& out, const char *sep, char fill, std::size_t from = 0, std::size_t to = ~std::size_t(0)) const
+	{
+		if (valid())
+			internal::render_packed(out, sep, fill, c.data(), c.size(), cols.data(), lines.data(), height, from, to);
+	}
+
+	/** Output lines [from, to) into a stream, by default all of them.
+	 *
+	 * @return Reference to the stream, so that it could be used later in
+	 * the same expression.
+	 */
+	inline std::ostream& render(std::ostream& os, const char *sep, char fill,
+			std::size_t from = 0, std::size_t to = ~std::size_t(0)) const
+	{
+		internal::ostream_sink out{os};
+
+		render(out, sep, fill, from, to);
+		return os;
+	}
+};
+
+}
+
+#endif /* TABULATOR_MAPPED_H_ */
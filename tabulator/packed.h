@@ -0,0 +1,413 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TABULATOR_PACKED_H_
+#define TABULATOR_PACKED_H_
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tabulator.h"
+
+namespace tabulator {
+
+namespace internal {
+
+// Lines between two absolute positions in a packed column
+enum : size_t { pack_block = 64 };
+
+struct anchor {
+	std::uint64_t byte; // offset of the first span of the block
+	std::uint64_t end;  // end of the text of the span before it
+};
+
+inline void put_varint(std::vector<unsigned char>& out, std::uint64_t v)
+{
+	for (; v >= 0x80; v >>= 7)
+		out.push_back(static_cast<unsigned char>(v | 0x80));
+	out.push_back(static_cast<unsigned char>(v));
+}
+
+// Reads a varint that must end before "lim"; false, with "p" at "lim", if it
+// does not or is longer than a 64-bit number takes
+inline bool get_varint(const unsigned char *& p, const unsigned char *lim, std::uint64_t& v)
+{
+	v = 0;
+	for (unsigned shift = 0; p < lim && shift < 64; shift += 7) {
+		const unsigned char b = *p++;
+		v |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+		if (b < 0x80)
+			return true;
+	}
+	p = lim;
+	return false;
+}
+
+// The lines of a column, a span each. A span is two varints: the distance
+// from the end of the previous line to its start, times four, plus its kind
+// (text, overflow marker or clipped line), then its length. Lines follow
+// each other in the text, so the distance is mostly 0 or 1 and the whole
+// span mostly takes two bytes. Every pack_block lines an anchor records
+// where the block starts, so that any line is found by decoding at most
+// pack_block spans.
+struct packed_spans {
+	const unsigned char *bytes;
+	size_t size; // of the bytes
+	const anchor *anchors;
+	size_t lines;
+};
+
+class span_encoder {
+	std::vector<unsigned char>& bytes;
+	std::vector<anchor>& anchors;
+	std::uint64_t end{0};
+	size_t lines{0};
+
+public:
+	inline span_encoder(std::vector<unsigned char>& b, std::vector<anchor>& a) : bytes(b), anchors(a) {}
+
+	inline void add(span s)
+	{
+		if (lines++ % pack_block == 0)
+			anchors.push_back(anchor{bytes.size(), end});
+		if (s.pos == span_marker) {
+			put_varint(bytes, 1);
+		} else if (s.pos == span_clipped) {
+			put_varint(bytes, 2);
+		} else {
+			put_varint(bytes, (s.pos - end) * 4);
+			end = s.pos + s.len;
+		}
+		put_varint(bytes, s.len);
+	}
+};
+
+class span_decoder {
+	const unsigned char *p, *lim;
+	std::uint64_t end;
+
+public:
+	// Positioned at line "ln" of the column, which must have lines
+	inline span_decoder(const packed_spans& s, size_t ln)
+		: p{s.bytes + s.anchors[ln / pack_block].byte}, lim{s.bytes + s.size}, end{s.anchors[ln / pack_block].end}
+	{
+		for (size_t i = ln / pack_block * pack_block; i < ln; ++i)
+			next();
+	}
+	inline span_decoder(void) : p{nullptr}, lim{nullptr}, end{0} {}
+
+	// The next line; no line at all past the end of the bytes
+	inline span next(void)
+	{
+		std::uint64_t v, len;
+
+		if (!get_varint(p, lim, v) || !get_varint(p, lim, len))
+			return span{span_none, 0};
+		if (v & 3)
+			return span{(v & 3) == 1 ? span_marker : span_clipped, static_cast<size_t>(len)};
+
+		const size_t pos = static_cast<size_t>(end + (v >> 2));
+		end = pos + len;
+		return span{pos, static_cast<size_t>(len)};
+	}
+};
+
+// Whether the packed lines of a column, e.g. from a file, can be decoded and
+// rendered: every anchor is where its block starts, every span is inside the
+// text, an overflow marker no longer than the marker, and the bytes hold
+// exactly the lines and nothing else
+inline bool check_spans(const packed_spans& s, const column& c)
+{
+	const unsigned char *p = s.bytes, *const lim = s.bytes + s.size;
+	const size_t more = c.maxlines ? std::strlen(c.more) : 0;
+	std::uint64_t end = 0;
+
+	for (size_t ln = 0; ln < s.lines; ++ln) {
+		const anchor& a = s.anchors[ln / pack_block];
+		std::uint64_t v, len;
+
+		if (ln % pack_block == 0 && (a.byte != static_cast<std::uint64_t>(p - s.bytes) || a.end != end))
+			return false;
+		if (!get_varint(p, lim, v) || !get_varint(p, lim, len) || (v & 3) == 3)
+			return false;
+		if ((v & 3) == 1 && len > more)
+			return false;
+		if ((v & 3) == 2 && len > c.width)
+			return false;
+		if ((v & 3) == 0) {
+			if ((v >> 2) > c.size - end || len > c.size - end - (v >> 2))
+				return false;
+			end += (v >> 2) + len;
+		}
+	}
+	return p == lim;
+}
+
+// A layout file: the header, a record per column, then for every column its
+// anchors and its spans, each starting at a multiple of 8 bytes. Numbers are
+// stored in the byte order of the machine: the files are caches.
+struct layout_header {
+	char magic[8];
+	std::uint64_t columns;
+	std::uint64_t height;
+};
+
+struct layout_record {
+	std::uint64_t key;
+	std::uint64_t lines;
+	std::uint64_t anchors_at;
+	std::uint64_t anchors;
+	std::uint64_t bytes_at;
+	std::uint64_t bytes;
+};
+
+static const char layout_magic[8] = {'T', 'A', 'B', 'L', 'A', 'Y', '0', '1'};
+
+inline std::uint64_t hash_bytes(std::uint64_t h, const char *p, size_t n)
+{
+	// 8 bytes at a time, so that hashing a text is much faster than laying it out
+	for (; n >= 8; p += 8, n -= 8) {
+		std::uint64_t w;
+		std::memcpy(&w, p, 8);
+		h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+		h ^= h >> 29;
+	}
+	for (; n; ++p, --n)
+		h = (h ^ static_cast<unsigned char>(*p)) * 0x100000001b3ULL;
+	return h;
+}
+
+inline std::uint64_t hash_str(std::uint64_t h, const char *s)
+{
+	return s ? hash_bytes(h, s, std::strlen(s) + 1) : h;
+}
+
+// What the layout of a column depends on: its text and all its settings
+inline std::uint64_t column_key(const column& c)
+{
+	const std::uint64_t settings[] = {
+		c.size, c.width, static_cast<std::uint64_t>(c.trunc), c.maxlines, static_cast<std::uint64_t>(c.va),
+		static_cast<std::uint64_t>(c.gen), c.base,
+	};
+	std::uint64_t h = hash_bytes(0xcbf29ce484222325ULL, reinterpret_cast<const char *>(settings), sizeof settings);
+
+	column::cursor at;
+
+	for (size_t pos = 0, n; pos < c.size; pos += n) {
+		const char *s = c.run(pos, n, at);
+		h = hash_bytes(h, s, n);
+	}
+	h = hash_str(h, c.more);
+	h = hash_str(h, c.cont);
+	h = hash_str(h, c.lead);
+	return hash_str(h, c.hang);
+}
+
+inline std::uint64_t align8(std::uint64_t n)
+{
+	return (n + 7) & ~std::uint64_t(7);
+}
+
+// Emits lines [from, to) of a row laid out into packed columns, decoding
+// each column once from the first line on.
+inline void render_packed(sink& out, const char *sep, char fill, const column *c, size_t n,
+		const packed_spans *cols, const size_t *lines, size_t height, size_t from, size_t to)
+{
+	const size_t seplen = std::strlen(sep);
+	std::vector<span_decoder> dec(n);
+	std::vector<size_t> top(n);
+	std::vector<span> row(n);
+	std::vector<column::cursor> at(n);
+
+	for (size_t col = 0; col < n; ++col) {
+		top[col] = top_line(c[col], height, lines[col]);
+
+		const size_t first = from > top[col] ? from - top[col] : 0;
+		if (first < lines[col])
+			dec[col] = span_decoder{cols[col], first};
+	}
+
+	for (size_t ln = from; ln < to && ln < height; ++ln) {
+		for (size_t col = 0; col < n; ++col)
+			row[col] = top[col] <= ln && ln - top[col] < lines[col] ? dec[col].next() : span{span_none, 0};
+		render_line(out, sep, seplen, fill, c, n, row.data(), lines, height, ln, at.data());
+	}
+}
+
+}
+
+/** A layout of columns of huge texts, stored compactly.
+ *
+ * Does the same as tabulator::layout, but keeps the lines of each column
+ * delta-encoded: about two bytes per line and column instead of sixteen,
+ * plus an absolute position every 64 lines for random access. Rendering
+ * decodes the lines sequentially as it goes. The column texts are not copied
+ * and must outlive the layout.
+ *
+ * Example:
+ * @code
+ *
+ * 	#include "packed.h"
+ *
+ * 	const tabulator::packed_layout log(column::numbers(1, 8), column{huge_log, 100});
+ *
+ * 	log.render(std::cout, " ", ' ', log.size() - 50, log.size());
+ *
+ * @endcode
+ */
+class packed_layout {
+	std::vector<column> c;
+	std::vector<std::vector<unsigned char>> bytes;
+	std::vector<std::vector<internal::anchor>> anchors;
+	std::vector<internal::packed_spans> cols;
+	std::vector<std::size_t> lines;
+	std::size_t height{0};
+
+public:
+	inline packed_layout(const column *columns, std::size_t n)
+		: bytes(n), anchors(n), lines(n)
+	{
+		std::vector<internal::colstate> state(n);
+
+		for (std::size_t col = 0; col < n; ++col)
+			c.push_back(columns[col]);
+		for (std::size_t col = 0; col < n; ++col) {
+			internal::span_encoder enc{bytes[col], anchors[col]};
+
+			for (; !internal::is_generated(c[col]) && !state[col].end(c[col]); state[col].breakLine(), ++lines[col])
+				enc.add(internal::next_span(state[col], c[col]));
+			bytes[col].shrink_to_fit();
+			cols.push_back(internal::packed_spans{bytes[col].data(), bytes[col].size(), anchors[col].data(), lines[col]});
+		}
+		height = internal::row_height(lines.data(), n);
+	}
+	template <typename... Cols, internal::force_type<column, Cols...> = 0>
+	inline explicit packed_layout(const Cols&... columns)
+		: packed_layout(std::array<column,sizeof...(columns)>{ {columns...} }.data(), sizeof...(columns)) {}
+	inline packed_layout(const packed_layout&) = delete;
+	inline packed_layout(packed_layout&&) = default;
+
+	/** The number of columns. */
+	inline std::size_t columns(void) const { return c.size(); }
+
+	/** The number of output lines. */
+	inline std::size_t size(void) const { return height; }
+
+	/** The number of bytes the encoded lines take. */
+	inline std::size_t memory(void) const
+	{
+		std::size_t m = 0;
+
+		for (std::size_t col = 0; col < c.size(); ++col)
+			m += bytes[col].size() + anchors[col].size() * sizeof(internal::anchor);
+		return m;
+	}
+
+	/** Write the layout into a file that mapped_layout can use instead of
+	 * laying the same columns out again.
+	 *
+	 * The file is written under a temporary name next to "path" and then
+	 * renamed to it, so processes that have mapped an older file at the
+	 * same path go on reading it unchanged.
+	 *
+	 * @return Whether the file has been written.
+	 */
+	inline bool save(const std::string& path) const
+	{
+		using internal::align8;
+
+		const std::size_t n = c.size();
+		internal::layout_header head;
+		std::vector<internal::layout_record> recs(n);
+		std::uint64_t at = align8(sizeof head + n * sizeof(internal::layout_record));
+
+		std::memcpy(head.magic, internal::layout_magic, sizeof head.magic);
+		head.columns = n;
+		head.height = height;
+		for (std::size_t col = 0; col < n; ++col) {
+			recs[col].key = internal::column_key(c[col]);
+			recs[col].lines = lines[col];
+			recs[col].anchors_at = at;
+			recs[col].anchors = anchors[col].size();
+			at = align8(at + anchors[col].size() * sizeof(internal::anchor));
+			recs[col].bytes_at = at;
+			recs[col].bytes = bytes[col].size();
+			at = align8(at + bytes[col].size());
+		}
+
+		// Written next to the file and renamed over it: processes that
+		// have the old file mapped keep it whole, new ones map the new one
+		const std::string tmp = path + ".tmp" + std::to_string(std::random_device{}());
+		std::ofstream out{tmp, std::ios::binary};
+		const char zeros[8] = {};
+		auto put = [&](const void *p, std::uint64_t len) {
+			out.write(static_cast<const char *>(p), static_cast<std::streamsize>(len));
+			out.write(zeros, static_cast<std::streamsize>(align8(len) - len));
+		};
+
+		out.write(reinterpret_cast<const char *>(&head), sizeof head);
+		put(recs.data(), n * sizeof(internal::layout_record));
+		for (std::size_t col = 0; col < n; ++col) {
+			put(anchors[col].data(), anchors[col].size() * sizeof(internal::anchor));
+			put(bytes[col].data(), bytes[col].size());
+		}
+		out.close();
+		if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+			std::remove(tmp.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	/** Output lines [from, to) into a sink, by default all of them. */
+	inline void render(sink& out, const char *sep, char fill, std::size_t from = 0, std::size_t to = ~std::size_t(0)) const
+	{
+		internal::render_packed(out, sep, fill, c.data(), c.size(), cols.data(), lines.data(), height, from, to);
+	}
+
+	/** Output lines [from, to) into a stream, by default all of them.
+	 *
+	 * @return Reference to the stream, so that it could be used later in
+	 * the same expression.
+	 */
+	inline std::ostream& render(std::ostream& os, const char *sep, char fill,
+			std::size_t from = 0, std::size_t to = ~std::size_t(0)) const
+	{
+		internal::ostream_sink out{os};
+
+		render(out, sep, fill, from, to);
+		return os;
+	}
+};
+
+}
+
+#endif /* TABULATOR_PACKED_H_ */
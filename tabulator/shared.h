@@ -0,0 +1,203 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TABULATOR_SHARED_H_
+#define TABULATOR_SHARED_H_
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "tabulator.h"
+
+namespace tabulator {
+
+/** A buffer that several threads output tables into, a whole line at a time.
+ *
+ * Each thread renders into a writer of its own, which assembles a line and
+ * appends it to the buffer under a mutex once the line is complete, so the
+ * lock is taken once per line and lines of different threads never mix.
+ * Another thread takes the text gathered so far with take(), holding the
+ * lock only for a swap, and outputs it wherever it has to go.
+ *
+ * Example:
+ * @code
+ *
+ * 	#include "shared.h"
+ *
+ * 	tabulator::locked_buffer log;
+ *
+ * 	// In each of the threads
+ * 	tabulator::locked_buffer::writer out{log};
+ * 	table.render(out, " | ", ' ');
+ *
+ * 	// In the thread that outputs the log
+ * 	std::string text;
+ * 	log.take(text);
+ * 	std::cout << text;
+ *
+ * @endcode
+ */
+class locked_buffer {
+	std::mutex m;
+	std::string text;
+
+public:
+	/** A sink of one thread into the buffer. */
+	class writer : public sink {
+		locked_buffer& b;
+		std::string line;
+
+	public:
+		inline explicit writer(locked_buffer& buf) : b(buf) {}
+
+		inline void write(const char *s, std::size_t n) override { line.append(s, n); }
+		inline void fill(char ch, std::size_t n) override { line.append(n, ch); }
+		inline void newline(void) override
+		{
+			line += '\n';
+			{
+				std::lock_guard<std::mutex> lock{b.m};
+
+				b.text.append(line);
+			}
+			line.clear();
+		}
+	};
+
+	/** Move the text gathered so far into "out", replacing its contents.
+	 * The memory of "out" is given to the buffer in exchange, so a caller
+	 * that keeps passing the same string does not make either of them
+	 * allocate anew.
+	 */
+	inline void take(std::string& out)
+	{
+		out.clear();
+		std::lock_guard<std::mutex> lock{m};
+
+		text.swap(out);
+	}
+};
+
+/** A buffer of fixed capacity that several threads output tables into
+ * without a lock.
+ *
+ * Each thread renders into a writer of its own, which assembles a line and,
+ * once the line is complete, reserves room for it with a single atomic
+ * addition and copies it there. Lines of different threads never mix, and
+ * no thread ever waits for another. A line that does not fit in what is
+ * left of the buffer is dropped and counted.
+ *
+ * The text is read with data() and size() once the writers are done, e.g.
+ * after their threads have been joined; the buffer is then clear()ed before
+ * it is written again.
+ *
+ * Example:
+ * @code
+ *
+ * 	#include "shared.h"
+ *
+ * 	tabulator::log_buffer log{64 << 20};
+ *
+ * 	// In each of the threads
+ * 	tabulator::log_buffer::writer out{log};
+ * 	table.render(out, " | ", ' ');
+ *
+ * 	// After the threads are joined
+ * 	std::cout.write(log.data(), log.size());
+ *
+ * @endcode
+ */
+class log_buffer {
+	std::unique_ptr<char[]> text;
+	std::size_t capacity;
+	std::atomic<std::size_t> used{0}; // bytes reserved, including past the end
+	std::atomic<std::size_t> end;     // where the line that did not fit begins
+	std::atomic<std::size_t> dropped{0};
+
+	inline void append(const std::string& line)
+	{
+		const std::size_t at = used.fetch_add(line.size(), std::memory_order_relaxed);
+
+		if (at + line.size() <= capacity) {
+			std::memcpy(text.get() + at, line.data(), line.size());
+			return;
+		}
+		// Reservations do not overlap, so only one line can begin inside
+		// the buffer and not fit
+		if (at < capacity)
+			end.store(at, std::memory_order_relaxed);
+		dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+
+public:
+	inline explicit log_buffer(std::size_t bytes) : text(new char[bytes]), capacity(bytes), end(bytes) {}
+
+	/** A sink of one thread into the buffer. */
+	class writer : public sink {
+		log_buffer& b;
+		std::string line;
+
+	public:
+		inline explicit writer(log_buffer& buf) : b(buf) {}
+
+		inline void write(const char *s, std::size_t n) override { line.append(s, n); }
+		inline void fill(char ch, std::size_t n) override { line.append(n, ch); }
+		inline void newline(void) override
+		{
+			line += '\n';
+			b.append(line);
+			line.clear();
+		}
+	};
+
+	/** The text of the lines in the buffer. */
+	inline const char *data(void) const { return text.get(); }
+
+	/** The number of bytes of the lines in the buffer. */
+	inline std::size_t size(void) const
+	{
+		const std::size_t n = used.load(std::memory_order_relaxed);
+		const std::size_t e = end.load(std::memory_order_relaxed);
+
+		return n < e ? n : e;
+	}
+
+	/** The number of lines that did not fit since the buffer was clear. */
+	inline std::size_t lost(void) const { return dropped.load(std::memory_order_relaxed); }
+
+	/** Empty the buffer. No writer may be outputting into it meanwhile. */
+	inline void clear(void)
+	{
+		used.store(0, std::memory_order_relaxed);
+		end.store(capacity, std::memory_order_relaxed);
+		dropped.store(0, std::memory_order_relaxed);
+	}
+};
+
+}
+
+#endif /* TABULATOR_SHARED_H_ */
@@ -0,0 +1,402 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TABULATOR_STREAM_H_
+#define TABULATOR_STREAM_H_
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "tabulator.h"
+
+namespace tabulator {
+
+/** Distribution of the lengths of the cells of a column.
+ *
+ * Lengths are counted up to a cap, so quantiles are exact for all lengths
+ * that matter for the layout, and the memory taken does not depend on the
+ * number of cells. A stream_table chooses its widths from these; use it to
+ * choose widths from a sample of cells of your own.
+ *
+ * Example:
+ * @code
+ *
+ * 	tabulator::length_sketch lengths{40};
+ *
+ * 	for (const auto& cell : first_rows)
+ * 		lengths.add(cell.size());
+ * 	const std::size_t width = lengths.quantile(0.9);
+ *
+ * @endcode
+ */
+class length_sketch {
+	std::vector<std::size_t> counts;
+	std::size_t total{0};
+
+public:
+	/** Create a sketch that counts lengths over "cap" as "cap". */
+	inline explicit length_sketch(std::size_t cap) : counts(cap + 1) {}
+
+	/** Count a length. */
+	inline void add(std::size_t len)
+	{
+		++counts[len < counts.size() ? len : counts.size() - 1];
+		++total;
+	}
+
+	/** The least length that at least a share "q" of the lengths do not exceed. */
+	inline std::size_t quantile(double q) const
+	{
+		const std::size_t rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(total)));
+		std::size_t seen = 0;
+
+		for (std::size_t len = 0; len < counts.size(); ++len)
+			if ((seen += counts[len]) >= (rank ? rank : 1))
+				return len;
+		return 0;
+	}
+};
+
+namespace internal {
+
+inline size_t longest_line(const std::string& s)
+{
+	size_t longest = 0, len = 0;
+
+	for (char ch : s) {
+		len = ch == '\n' ? 0 : len + 1;
+		longest = len > longest ? len : longest;
+	}
+	return longest;
+}
+
+// Widths as close to the wanted ones as "room" allows: if they do not fit,
+// all columns wider than some level are cut down to it, the highest level
+// that fits.
+inline std::vector<size_t> fit_widths(const std::vector<size_t>& want, size_t room)
+{
+	size_t lo = 1, hi = room ? room : 1;
+
+	while (lo < hi) {
+		const size_t level = lo + (hi - lo + 1) / 2;
+		size_t sum = 0;
+
+		for (size_t w : want)
+			sum += w < level ? w : level;
+		if (sum <= room)
+			lo = level;
+		else
+			hi = level - 1;
+	}
+
+	std::vector<size_t> widths;
+	for (size_t w : want)
+		widths.push_back(w < 1 ? 1 : w < lo ? w : lo);
+	return widths;
+}
+
+}
+
+/** Lengths of the cells of the columns of a table, kept between runs.
+ *
+ * For every column, a profile holds the cell lengths at a few quantiles. A
+ * stream_table that is given the profile of an earlier run of the same
+ * report chooses its widths from it right away, without holding back any
+ * rows. The file format is a line of text per column.
+ */
+class width_profile {
+public:
+	static constexpr std::size_t levels = 6;
+
+	/** The quantiles the profile keeps lengths at */
+	static inline const std::array<double,levels>& quantiles(void)
+	{
+		static const std::array<double,levels> q{ {0.5, 0.75, 0.9, 0.95, 0.99, 1.0} };
+		return q;
+	}
+
+	std::vector<std::array<std::size_t,levels>> cols;
+
+	/** The number of columns, zero for an empty profile. */
+	inline std::size_t columns(void) const { return cols.size(); }
+
+	/** The length of the cells of column "col" at the smallest kept quantile not below "q". */
+	inline std::size_t length(std::size_t col, double q) const
+	{
+		std::size_t i = 0;
+
+		while (i + 1 < levels && quantiles()[i] < q)
+			++i;
+		return cols[col][i];
+	}
+
+	/** Read a profile from a file.
+	 *
+	 * @return Whether the file has been read. A missing or malformed file
+	 * leaves the profile empty.
+	 */
+	inline bool load(const std::string& path)
+	{
+		std::ifstream in{path};
+		std::string magic;
+		std::size_t n = 0;
+
+		cols.clear();
+		if (!(in >> magic >> n) || magic != "tabulator-widths")
+			return false;
+		// Grow with what the file holds, not with the count it claims
+		for (std::size_t i = 0; i < n; ++i) {
+			std::array<std::size_t,levels> col;
+
+			for (auto& len : col)
+				if (!(in >> len)) {
+					cols.clear();
+					return false;
+				}
+			cols.push_back(col);
+		}
+		return true;
+	}
+
+	/** Write the profile into a file.
+	 *
+	 * @return Whether the file has been written.
+	 */
+	inline bool save(const std::string& path) const
+	{
+		std::ofstream out{path};
+
+		out << "tabulator-widths " << cols.size() << '\n';
+		for (const auto& col : cols) {
+			for (std::size_t i = 0; i < levels; ++i)
+				out << (i ? " " : "") << col[i];
+			out << '\n';
+		}
+		return static_cast<bool>(out.flush());
+	}
+};
+
+/** Output a table whose rows come one by one, choosing column widths on the way.
+ *
+ * The table holds back the first rows, up to a number of them or for a time
+ * window, and measures the lengths of their cells. Then it chooses the width
+ * of each column as a quantile of those lengths, shrinking the widest columns
+ * if the table does not fit in "total" characters, outputs the rows it holds
+ * and outputs every following row as soon as it comes. Memory taken after the
+ * sample does not depend on the number of rows. Optionally, the widths keep
+ * adapting: a column whose cells turn out to be longer than in the sample
+ * gets wider while the table still fits.
+ *
+ * With a width_profile saved by an earlier run, no rows are held back at all:
+ * the widths come from the profile, and the profile of this run can be saved
+ * for the next one.
+ *
+ * Example:
+ * @code
+ *
+ * 	#include "stream.h"
+ *
+ * 	tabulator::stream_table table{std::cout, 120, " | "};
+ *
+ * 	tabulator::width_profile last;
+ *
+ * 	table.sample(50, std::chrono::milliseconds{200}).adaptive(true);
+ * 	if (last.load("report.widths"))
+ * 		table.profile(last);
+ * 	while (read_record(rec))
+ * 		table.row({rec.time, rec.level, rec.message});
+ * 	table.finish();
+ * 	table.profile().save("report.widths");
+ *
+ * @endcode
+ */
+class stream_table {
+	internal::ostream_sink out;
+	const std::size_t total;
+	const char * const sep;
+	const char fill;
+	std::size_t rows{100};
+	std::chrono::steady_clock::duration window{};
+	double q{0.9};
+	bool adapt{false};
+
+	std::vector<length_sketch> sketches;
+	std::vector<std::size_t> widths;
+	std::vector<std::vector<std::string>> pending;
+	std::chrono::steady_clock::time_point start;
+	std::vector<column> cols;
+	std::vector<internal::colstate> state;
+
+	inline std::size_t room(std::size_t n) const
+	{
+		const std::size_t seps = (n - 1) * std::strlen(sep);
+
+		return total > seps ? total - seps : n;
+	}
+	inline std::vector<std::size_t> wanted(void) const
+	{
+		std::vector<std::size_t> want;
+
+		for (const auto& s : sketches)
+			want.push_back(s.quantile(q));
+		return want;
+	}
+	inline void measure(const std::vector<std::string>& cells)
+	{
+		if (sketches.empty())
+			sketches.assign(widths.size() ? widths.size() : cells.size() ? cells.size() : 1, length_sketch{total});
+		for (std::size_t col = 0; col < sketches.size() && col < cells.size(); ++col)
+			sketches[col].add(internal::longest_line(cells[col]));
+	}
+	inline void widen(void)
+	{
+		const std::vector<std::size_t> want = wanted();
+		std::size_t used = 0;
+
+		for (std::size_t w : widths)
+			used += w;
+		const std::size_t space = room(widths.size());
+
+		for (std::size_t col = 0; col < widths.size() && col < want.size() && used < space; ++col) {
+			if (want[col] <= widths[col])
+				continue;
+			const std::size_t grow = want[col] - widths[col] < space - used ? want[col] - widths[col] : space - used;
+			widths[col] += grow;
+			used += grow;
+		}
+	}
+	inline void emit(const std::vector<std::string>& cells)
+	{
+		cols.clear();
+		for (std::size_t col = 0; col < widths.size(); ++col)
+			cols.push_back(col < cells.size() ? column{cells[col], widths[col]} : column{"", 0, widths[col]});
+		state.assign(cols.size(), internal::colstate{});
+		internal::render(out, sep, fill, cols.data(), state.data(), cols.size());
+	}
+	inline void stream(void)
+	{
+		widths = internal::fit_widths(wanted(), room(sketches.size()));
+		for (const auto& cells : pending)
+			emit(cells);
+		pending.clear();
+		pending.shrink_to_fit();
+	}
+
+public:
+	/** Create a streamed table.
+	 *
+	 * @param os		an ostream object to output text into
+	 * @param width		the maximum width of the table
+	 * @param separator	a string to separate the columns with
+	 * @param filler	a character to fill the space between the last
+	 *              	character in a column on a given line and the separator
+	 */
+	inline stream_table(std::ostream& os, std::size_t width, const char *separator = " ", char filler = ' ')
+		: out{os}, total{width}, sep{separator}, fill{filler} {}
+	inline stream_table(const stream_table&) = delete;
+	inline ~stream_table() { finish(); }
+
+	/** Set how many rows, and for how long at most, to hold back to choose the widths.
+	 *
+	 * A zero window means no time limit. The default is 100 rows.
+	 */
+	inline stream_table& sample(std::size_t n, std::chrono::milliseconds limit = std::chrono::milliseconds{0})
+	{
+		rows = n;
+		window = limit;
+		return *this;
+	}
+
+	/** Set the quantile of the cell lengths a column is made wide enough for; 0.9 by default. */
+	inline stream_table& quantile(double share) { q = share; return *this; }
+
+	/** Let the columns get wider after the sample if their cells get longer. */
+	inline stream_table& adaptive(bool on) { adapt = on; return *this; }
+
+	/** Choose the widths from the profile of an earlier run instead of a sample. */
+	inline stream_table& profile(const width_profile& last)
+	{
+		std::vector<std::size_t> want;
+
+		for (std::size_t col = 0; col < last.columns(); ++col)
+			want.push_back(last.length(col, q));
+		if (!want.empty() && pending.empty())
+			widths = internal::fit_widths(want, room(want.size()));
+		return *this;
+	}
+
+	/** The profile of the cells output so far, to be saved for the next run. */
+	inline width_profile profile(void) const
+	{
+		width_profile p;
+
+		for (const auto& s : sketches) {
+			p.cols.emplace_back();
+			for (std::size_t i = 0; i < width_profile::levels; ++i)
+				p.cols.back()[i] = s.quantile(width_profile::quantiles()[i]);
+		}
+		return p;
+	}
+
+	/** Output a row, or hold it back while the widths are not chosen yet.
+	 *
+	 * The number of columns is that of the profile or of the first row:
+	 * extra cells of other rows are ignored, missing ones are empty.
+	 */
+	inline stream_table& row(const std::vector<std::string>& cells)
+	{
+		const bool sampling = widths.empty();
+
+		measure(cells);
+		if (!sampling) {
+			if (adapt)
+				widen();
+			emit(cells);
+			return *this;
+		}
+
+		if (pending.empty())
+			start = std::chrono::steady_clock::now();
+		pending.push_back(cells);
+		if (pending.size() >= rows || (window.count() && std::chrono::steady_clock::now() - start >= window))
+			stream();
+		return *this;
+	}
+
+	/** Output the rows held back, if any; to be called after the last row. */
+	inline void finish(void)
+	{
+		if (widths.empty() && !pending.empty())
+			stream();
+	}
+};
+
+}
+
+#endif /* TABULATOR_STREAM_H_ */
@@ -25,111 +25,368 @@ SOFTWARE.
 #ifndef TEST_TABULATOR_H_
 #define TEST_TABULATOR_H_
 
+#include <algorithm>
 #include <array>
-#include <cctype>
-#include <cstring>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <utility>
+#include <vector>
 
-#include <type_traits>
+#include "tabulator_core.h"
 
 namespace tabulator {
 
-struct column {
-	const char * const p;
-	const std::size_t size;
-	const std::size_t width;
-
-	inline column(const char *s, std::size_t w) : p{s}, size{std::strlen(s)}, width{w} {}
-	inline column(const std::string& s, std::size_t w) : p{s.c_str()}, size{s.size()}, width{w} {}
-	inline column(const column&) = default;
-};
-
 namespace internal {
 
-using std::array;
-using std::enable_if;
-using std::isblank;
-using std::is_same;
 using std::ostream;
-using std::size_t;
 using std::string;
 
-// Thanks to https://www.fluentcpp.com/2019/01/25/variadic-number-function-parameters-type/
-// and https://en.cppreference.com/w/cpp/experimental/conjunction#Example
-template<bool...> struct bool_pack{};
-template<class... Us>
-using conjunction = is_same<bool_pack<true,Us::value...>, bool_pack<Us::value...,true> >;
-
-template <class T, class... Ts>
-using force_type = typename enable_if<conjunction<is_same<T, Ts>...>::value, int>::type;
-
-struct colstate {
-	size_t cp{0}; // index in the whole column text
-	size_t lp{0}; // index in the currently emitted line
-
-	inline char consume(const column& c) { return end(c) ? 0 : c.p[cp++]; }
-	inline colstate& emit(ostream& os, char ch) { os.put(ch); ++lp; return *this; }
-	inline colstate& breakLine(void) { lp = 0; return *this; }
-	inline bool linebreak(char ch, const column& c) const;
-	inline bool nextWordFits(const column& c) const;
-	inline bool end(const column& c) const { return c.size <= cp; }
+struct ostream_sink : sink {
+	ostream& os;
+	string line;
+
+	inline explicit ostream_sink(ostream& s) : os(s) {}
+
+	inline void write(const char *s, size_t n) override { line.append(s, n); }
+	inline void fill(char ch, size_t n) override { line.append(n, ch); }
+	inline void newline(void) override
+	{
+		// Hand a complete line to the stream in one call and reuse the buffer
+		line += '\n';
+		os.write(line.data(), static_cast<std::streamsize>(line.size()));
+		line.clear();
+	}
+};
+
+// Escapes the text for HTML; fill is not needed in cells of a table
+struct html_sink : sink {
+	ostream& os;
+
+	inline explicit html_sink(ostream& s) : os(s) {}
+
+	inline void write(const char *s, size_t n) override
+	{
+		for (size_t i = 0; i < n; ++i) {
+			switch (s[i]) {
+			case '&': os << "&amp;"; break;
+			case '<': os << "&lt;"; break;
+			case '>': os << "&gt;"; break;
+			case '"': os << "&quot;"; break;
+			default: os.put(s[i]);
+			}
+		}
+	}
+	inline void fill(char, size_t) override {}
+	inline void newline(void) override {}
 };
 
-inline bool isws(char ch)
+inline void measure(std::vector<span>& spans, std::vector<size_t>& lines, const column *c, colstate *state, size_t n)
 {
-	return isblank(static_cast<unsigned char>(ch));
+	// Lay out every column first, to know the height of the row
+	spans.clear();
+	lines.assign(n, 0);
+	for (size_t col = 0; col < n; ++col)
+		for (; !is_generated(c[col]) && !state[col].end(c[col]); state[col].breakLine(), ++lines[col])
+			spans.push_back(next_span(state[col], c[col]));
 }
 
-inline bool colstate::linebreak(char ch, const column& c) const
-{
-	// Line break: ch is \\n or (ws and next word cannot be emitted).
-	return ch == '\n' || (isws(ch) && !nextWordFits(c));
 }
 
-inline bool colstate::nextWordFits(const column& c) const
-{
-	const size_t colwidth = c.width;
-	const char *s = c.p;
-	size_t l = lp;
+/** Columns of text broken into lines, ready to be output as many times as needed.
+ *
+ * Laying out is separated from output: a layout records, for every output
+ * line and every column, which part of the column text goes there, and can
+ * then be rendered into any number of streams, sinks or HTML documents
+ * without looking for line breaks again. The column texts are not copied and
+ * must outlive the layout.
+ *
+ * Example:
+ * @code
+ *
+ * 	const tabulator::layout table(column{name, 12}, column{description, 40});
+ *
+ * 	table.render(std::cout, " | ", ' ');
+ * 	table.render(logfile, " ", ' ');
+ * 	table.html(report);
+ *
+ * @endcode
+ */
+class layout {
+	std::vector<column> c;
+	std::vector<internal::span> spans; // line by line, a span for each column
+	std::vector<std::size_t> lines;    // number of lines of each column
+	std::size_t height{0};
+
+public:
+	inline layout() = default;
+	inline layout(const column *cols, std::size_t n) { assign(cols, n); }
+	template <typename... Cols, internal::force_type<column, Cols...> = 0>
+	inline explicit layout(const Cols&... cols)
+	{
+		const std::array<column,sizeof...(cols)> a{ cols... };
+
+		assign(a.data(), a.size());
+	}
 
-	// Next word can be emitted: lp will be at most colwidth on next ws.
-	for (size_t i = cp; s[i] && l < colwidth; ++i, ++l)
-		if (isws(s[i]))
-			return true;
+	/** Lay out "n" columns anew, reusing the memory of this layout. */
+	inline void assign(const column *cols, std::size_t n)
+	{
+		std::vector<internal::colstate> state(n);
+		std::vector<internal::span> bycol;
+
+		c.clear();
+		for (std::size_t col = 0; col < n; ++col)
+			c.push_back(cols[col]);
+		internal::measure(bycol, lines, c.data(), state.data(), n);
+		height = internal::row_height(lines.data(), n);
+
+		// Put the lines of each column on the output lines they go to
+		spans.assign(height * n, internal::span{internal::span_none, 0});
+		for (std::size_t col = 0, i = 0; col < n; ++col) {
+			const std::size_t top = internal::top_line(c[col], height, lines[col]);
+
+			for (std::size_t ln = 0; ln < lines[col]; ++ln)
+				spans[(top + ln) * n + col] = bycol[i++];
+		}
+	}
 
-	return l < colwidth;
-}
+	/** The number of columns. */
+	inline std::size_t columns(void) const { return c.size(); }
 
-inline void switch_col(ostream& os, colstate& state, size_t colwidth, char fill, const string& sep)
-{
-	const size_t inc = fill == '\t' ? 8 : 1;
+	/** The number of output lines. */
+	inline std::size_t size(void) const { return height; }
+
+	/** Output line "ln" into a sink. */
+	inline void render_line(sink& out, const char *sep, char fill, std::size_t ln) const
+	{
+		render(out, sep, fill, ln, ln + 1);
+	}
 
-	// Switch to next column: emit fill up to colwidth, emit sep
-	for (size_t i = state.lp; i < colwidth; i += inc)
-		os.put(fill);
-	os << sep;
+	/** Output lines [from, to) into a sink, by default all of them. */
+	inline void render(sink& out, const char *sep, char fill, std::size_t from = 0, std::size_t to = ~std::size_t(0)) const
+	{
+		const std::size_t seplen = std::strlen(sep);
+		std::vector<column::cursor> at(c.size());
+
+		for (std::size_t ln = from; ln < to && ln < height; ++ln)
+			internal::render_line(out, sep, seplen, fill, c.data(), c.size(), spans.data() + ln * c.size(),
+					lines.data(), height, ln, at.data());
+	}
+
+	/** Output all lines into a stream, like tabulate() would.
+	 *
+	 * @return Reference to the stream, so that it could be used later in
+	 * the same expression.
+	 */
+	inline std::ostream& render(std::ostream& os, const char *sep, char fill) const
+	{
+		internal::ostream_sink out{os};
+
+		render(out, sep, fill);
+		return os;
+	}
+
+	/** Find the first output line, starting at line "from", where a match
+	 * of "needle" in the text of some column begins.
+	 *
+	 * The text of the columns is searched where it is stored, nothing is
+	 * rendered, and each column is searched no further than the best line
+	 * found so far. A match in text that truncation or a line limit hides
+	 * counts on the line that hides it. Generated columns are not
+	 * searched.
+	 *
+	 * Example:
+	 * @code
+	 *
+	 * 	for (std::size_t ln = l.find("error"); ln < l.size(); ln = l.find("error", ln + 1))
+	 * 		l.render_line(out, " | ", ' ', ln);
+	 *
+	 * @endcode
+	 *
+	 * @param needle	a non-empty string to look for
+	 * @param from		the first output line to consider
+	 * @return The output line, or size() if there is no match.
+	 */
+	inline std::size_t find(const char *needle, std::size_t from = 0) const
+	{
+		const std::size_t m = std::strlen(needle);
+		const std::size_t n = c.size();
+		std::size_t best = height;
+
+		if (!m)
+			return best;
+		for (std::size_t col = 0; col < n && from < best; ++col) {
+			const std::size_t top = internal::top_line(c[col], height, lines[col]);
+			const std::size_t first = from > top ? from - top : 0;
+			const std::size_t last = best - top < lines[col] ? best - top : lines[col];
+
+			if (internal::is_generated(c[col]) || top >= best || first >= last)
+				continue;
+
+			// Where in the text column line k starts; the hidden text
+			// after a limited column's last line starts its marker line
+			const auto start = [&](std::size_t k) -> std::size_t {
+				const internal::span s = spans[(top + k) * n + col];
+				if (s.pos < internal::span_none)
+					return s.pos;
+				if (!k)
+					return 0;
+				const internal::span prev = spans[(top + k - 1) * n + col];
+				return prev.pos + prev.len;
+			};
+
+			const std::size_t end = last < lines[col] ? start(last) : c[col].size;
+			const std::size_t at = internal::find_text(c[col], start(first), end, needle, m);
+			if (at >= end)
+				continue;
+
+			// The last line of the column that starts at or before the match
+			std::size_t lo = first, hi = last - 1;
+			while (lo < hi) {
+				const std::size_t mid = lo + (hi - lo + 1) / 2;
+				if (start(mid) <= at)
+					lo = mid;
+				else
+					hi = mid - 1;
+			}
+			best = top + lo;
+		}
+		return best;
+	}
+
+	/** Output all lines into a stream as an HTML table.
+	 *
+	 * Every output line becomes a table row and every column a cell in
+	 * it, with the text escaped. Style the table with "white-space: pre"
+	 * to keep the spaces of the text.
+	 *
+	 * @return Reference to the stream, so that it could be used later in
+	 * the same expression.
+	 */
+	inline std::ostream& html(std::ostream& os) const
+	{
+		internal::html_sink out{os};
+		std::vector<column::cursor> at(c.size());
+
+		os << "<table>\n";
+		for (std::size_t ln = 0; ln < height; ++ln) {
+			os << "<tr>";
+			for (std::size_t col = 0; col < c.size(); ++col) {
+				const internal::span s = spans[ln * c.size() + col];
+
+				os << "<td>";
+				if (internal::is_generated(c[col])) {
+					internal::colstate state;
+
+					state.ln = ln;
+					internal::emit_span(out, c[col], internal::next_span(state, c[col]), ln, at[col]);
+				} else if (s.pos != internal::span_none) {
+					internal::emit_span(out, c[col], s, ln - internal::top_line(c[col], height, lines[col]), at[col]);
+				}
+				os << "</td>";
+			}
+			os << "</tr>\n";
+		}
+		return os << "</table>\n";
+	}
+};
+
+namespace internal {
+
+struct string_sink : sink {
+	string& s;
+
+	inline explicit string_sink(string& str) : s(str) {}
+
+	inline void write(const char *p, size_t n) override { s.append(p, n); }
+	inline void fill(char ch, size_t n) override { s.append(n, ch); }
+	inline void newline(void) override { s += '\n'; }
+};
+
+// Tables of at least this many columns are output by render_wide()
+enum : size_t { wide_columns = 32 };
+
+inline bool is_wide(const column *c, size_t n)
+{
+	if (n < wide_columns || !is_top_aligned(c, n))
+		return false;
+	for (size_t col = 0; col < n; ++col)
+		if (c[col].size > UINT32_MAX || c[col].segs)
+			return false;
+	return true;
 }
 
-inline void emit_col(ostream& os, colstate& state, const column& c)
+// Same output as render() for many top-aligned contiguous columns. The state
+// of a column is the 32-bit position in its text, since all columns are on the
+// same line.
+// Only the columns with text left, and the generated ones, are laid out; they
+// are listed in order, and every run of the other columns between them is
+// output as a single block of fill and separators, prepared once.
+inline void render_wide(sink& out, const char *sep, char fill, const column *c, size_t n)
 {
-	// Emit column characters: consume ch. If line break, then stop, else emit.
-	for (char ch = state.consume(c); !!ch; ch = state.consume(c)) {
-		if (!state.linebreak(ch, c))
-			state.emit(os, ch);
-		else
-			break;
+	const size_t seplen = std::strlen(sep);
+	std::vector<uint32_t> cp(n), active;
+	std::vector<size_t> at(n + 1); // where the blank of each column starts
+	string blank;
+	string_sink b{blank};
+	size_t left = 0;               // the active columns that are not generated
+
+	for (size_t col = 0; col < n; ++col) {
+		at[col] = blank.size();
+		if (col + 1 < n)
+			switch_col(b, 0, c[col].width, fill, sep, seplen);
+		if (is_generated(c[col]) || c[col].size) {
+			active.push_back(static_cast<uint32_t>(col));
+			left += !is_generated(c[col]);
+		}
+	}
+	at[n] = blank.size();
+
+	for (size_t ln = 0; left; ++ln) {
+		size_t next = 0, kept = 0;
+
+		for (const uint32_t col : active) {
+			colstate state;
+
+			if (next < col)
+				out.write(blank.data() + at[next], at[col] - at[next]);
+			state.cp = cp[col];
+			state.ln = ln;
+			emit_span(out, c[col], next_span(state, c[col]), ln, state.at);
+			if (col + 1 < n)
+				switch_col(out, state.lp, c[col].width, fill, sep, seplen);
+			cp[col] = static_cast<uint32_t>(state.cp);
+			next = col + 1;
+
+			if (!is_generated(c[col]) && state.end(c[col]))
+				--left;
+			else
+				active[kept++] = col;
+		}
+		active.resize(kept);
+		if (next < n)
+			out.write(blank.data() + at[next], at[n] - at[next]);
+		out.newline();
 	}
 }
 
-template <size_t N>
-inline bool is_unconsumed(const array<colstate,N>& state, const array<column,N> c)
+inline ostream& tabulate(ostream& os, const char *sep, char fill, const column *c, colstate *state, size_t n)
 {
-	for (size_t i = 0; i < N; ++i)
-		if (!state[i].end(c[i]))
-			return true;
-	return false;
+	if (is_wide(c, n)) {
+		ostream_sink out{os};
+
+		render_wide(out, sep, fill, c, n);
+		return os;
+	}
+	if (is_top_aligned(c, n)) {
+		ostream_sink out{os};
+
+		render(out, sep, fill, c, state, n);
+		return os;
+	}
+
+	return layout{c, n}.render(os, sep, fill);
 }
 
 }
@@ -142,6 +399,15 @@ inline bool is_unconsumed(const array<colstate,N>& state, const array<column,N>
  * space between the last character in a line and column separator is filled
  * with "fill" character. The operation is done in O(N) time.
  *
+ * Every output line is assembled in memory first and handed to the stream by
+ * a single write() call, so a stream shared by several threads is touched
+ * once per line instead of once per character. The standard does not promise
+ * that concurrent writes to one stream keep lines whole: std::cout
+ * synchronized with stdio does so in libstdc++, which locks the C stream for
+ * each write(), but that is a property of the implementation. The sinks of
+ * shared.h give each thread a writer of its own and keep lines whole
+ * everywhere.
+ *
  * @param os		an ostream object to output text into
  * @param sep		a string to separate the columns with
  * @param fill		a character to fill the space between the last
@@ -170,24 +436,49 @@ inline bool is_unconsumed(const array<colstate,N>& state, const array<column,N>
 template <typename... Cols, internal::force_type<column, Cols...> = 0>
 inline std::ostream& tabulate(std::ostream& os, const char *sep, char fill, const Cols&... cols)
 {
-	using namespace internal;
-
-	array<colstate,sizeof...(cols)> state;
-	array<column,sizeof...(cols)> c{ cols... };
-
-	// Emit lines until all character pointers are at the end of their strings
-	for (bool unconsumed = is_unconsumed(state, c); unconsumed; unconsumed = is_unconsumed(state, c)) {
-		// Line emit: emit column characters then (if not last col, then switch to next column) then break line
-		for (size_t col = 0; col < sizeof...(cols); ++col) {
-			emit_col(os, state[col], c[col]);
-			if ((col + 1) < sizeof...(cols))
-				switch_col(os, state[col], c[col].width, fill, sep);
-			state[col].breakLine();
-		}
-		os << '\n';
-	}
+	std::array<internal::colstate,sizeof...(cols)> state;
+	const std::array<column,sizeof...(cols)> c{ cols... };
 
-	return os;
+	return internal::tabulate(os, sep, fill, c.data(), state.data(), c.size());
+}
+
+/** Output a run-time number of columns of text into a stream.
+ *
+ * This is an overload of tabulate(ostream&, const char*, char, Cols...) for
+ * the case when the columns are only known at run time. It produces exactly
+ * the same output as the variadic overload given the same columns.
+ *
+ * Wide tables, such as matrices of thousands of columns, are output in a mode
+ * of their own: each column keeps 4 bytes of state, only the columns that
+ * still have text are laid out on a line, and the blank columns between them
+ * are output in blocks. Columns that are not aligned to the top, or texts of
+ * 4 GiB or more, use the general path.
+ *
+ * @param os		an ostream object to output text into
+ * @param sep		a string to separate the columns with
+ * @param fill		a character to fill the space between the last
+ *            		character in a column on a given line and the separator
+ * @param cols		pointer to the first of "n" "column" structures
+ * @param n		the number of columns
+ *
+ * Example:
+ * @code
+ *
+ * 	std::vector<tabulator::column> cols;
+ * 	for (const auto& s : texts)
+ * 		cols.emplace_back(s, 10);
+ * 	tabulator::tabulate(std::cout, " | ", ' ', cols.data(), cols.size());
+ *
+ * @endcode
+ *
+ * @return Reference to the stream, so that it could be used later in the same
+ * expression that has called the function.
+ */
+inline std::ostream& tabulate(std::ostream& os, const char *sep, char fill, const column *cols, std::size_t n)
+{
+	std::vector<internal::colstate> state(internal::is_wide(cols, n) ? 0 : n);
+
+	return internal::tabulate(os, sep, fill, cols, state.data(), n);
 }
 
 /** Output one or more space-filled columns of text into a stream.
@@ -258,6 +549,430 @@ inline std::ostream& tabulate(std::ostream& os, const Cols&... cols)
 	return tabulate(os, " ", ' ', cols...);
 }
 
+/** Output the last lines of a column of text into a stream.
+ *
+ * The output is the same as the last "n" lines tabulate() would output for
+ * the column, but only the paragraphs that make them up are laid out: the
+ * text is scanned back from its end to the hard newlines before them. The
+ * time it takes thus depends on the length of the output, not of the text,
+ * unless the last paragraph is as long as the text.
+ *
+ * Example:
+ * @code
+ *
+ * 	// The end of a log, wrapped to 80 characters
+ * 	tabulator::tabulate_tail(std::cout, 25, column{log.data(), log.size(), 80});
+ *
+ * @endcode
+ *
+ * @param os		an ostream object to output text into
+ * @param n		the number of lines to output at most
+ * @param c		the column
+ *
+ * @return Reference to the stream, so that it could be used later in the same
+ * expression that has called the function.
+ */
+inline std::ostream& tabulate_tail(std::ostream& os, std::size_t n, const column& c)
+{
+	internal::ostream_sink out{os};
+	internal::colstate state = internal::tail(c, n);
+
+	internal::render(out, "", ' ', &c, &state, 1);
+	return os;
+}
+
+/** Output a column of text flowing through several columns, like a newspaper.
+ *
+ * The text fills the first column, goes on at the top of the second one, and
+ * so on. The heights of the columns are balanced: they differ by one line at
+ * most, the taller columns coming first, so 5 lines through 4 columns give
+ * columns of 2, 1, 1 and 1 lines. The text is broken into lines once, and the
+ * lines are then dealt out to the columns; each is as wide as the column "c".
+ *
+ * Example:
+ * @code
+ *
+ * 	tabulator::tabulate_flow(std::cout, 3, "   ", ' ', column{article, 24});
+ *
+ * @endcode
+ *
+ * @param os		an ostream object to output text into
+ * @param k		the number of columns to flow the text through
+ * @param sep		a string to separate the columns with
+ * @param fill		a character to fill the space between the last
+ *            		character in a column on a given line and the separator
+ * @param c		the column, the width of each of the "k" columns
+ *
+ * @return Reference to the stream, so that it could be used later in the same
+ * expression that has called the function.
+ */
+inline std::ostream& tabulate_flow(std::ostream& os, std::size_t k, const char *sep, char fill, const column& c)
+{
+	internal::ostream_sink out{os};
+	internal::colstate state;
+	std::vector<internal::span> spans;
+	std::vector<std::size_t> lines;
+	const std::size_t seplen = std::strlen(sep);
+
+	internal::measure(spans, lines, &c, &state, 1);
+
+	// The first "taller" columns take a line more than the others
+	const std::size_t shorter = k ? lines[0] / k : 0, taller = k ? lines[0] % k : 0;
+	const std::size_t height = shorter + (taller != 0);
+	std::vector<column::cursor> at(k);
+	for (std::size_t ln = 0; ln < height; ++ln) {
+		for (std::size_t col = 0; col < k; ++col) {
+			const std::size_t i = col * shorter + (col < taller ? col : taller) + ln;
+			std::size_t lp = 0;
+
+			if (ln < shorter + (col < taller)) {
+				internal::emit_span(out, c, spans[i], i, at[col]);
+				lp = internal::prefix_len(c, i) + spans[i].len;
+			}
+			if (col + 1 < k)
+				internal::switch_col(out, lp, c.width, fill, sep, seplen);
+		}
+		out.newline();
+	}
+	return os;
+}
+
+/** Output a table row by row into pages of a fixed number of lines.
+ *
+ * Every page is exactly "lines" lines long: the header at the top, the footer
+ * at the bottom and the rows in between, with empty lines before the footer
+ * of a page that is not full. A row that does not fit on the rest of a page
+ * starts a new page, unless it is taller than a whole page: then it is split.
+ * The header and the footer must leave at least a line of every page to the
+ * rows; header() and footer() refuse columns that would not.
+ *
+ * Page breaks are decided in a single forward pass over the rows: each row is
+ * laid out once, its height tells where it goes, and the laid out lines are
+ * then emitted without laying the row out again. The header and the footer
+ * are laid out once, when they are set. Their texts, like the texts of all
+ * columns, must outlive the paginator.
+ *
+ * Example:
+ * @code
+ *
+ * 	tabulator::paginator pages{std::cout, 60, " | "};
+ *
+ * 	if (!pages.header(column{"Name", 20}, column{"Description", 50})
+ * 			|| !pages.footer(column{"-- ACME Corp. confidential --", 73}))
+ * 		return; // the page is too short for them
+ * 	for (const auto& item : items)
+ * 		pages.row(column{item.name, 20}, column{item.description, 50});
+ * 	pages.finish();
+ *
+ * @endcode
+ */
+class paginator {
+	internal::ostream_sink out;
+	const std::size_t budget;
+	const char * const sep;
+	const char fill;
+	layout head, foot, body, next;
+	std::size_t top{0};  // lines of the header of the open page
+	std::size_t used{0}; // lines of rows on the open page
+	bool open{false};
+
+	inline bool fits(std::size_t header, std::size_t footer) const { return header + footer < budget; }
+	inline std::size_t room(void) const
+	{
+		const std::size_t frame = (open ? top : head.size()) + foot.size();
+
+		return budget > frame ? budget - frame : 1; // only for a budget of 0
+	}
+	inline void open_page(void)
+	{
+		head.render(out, sep, fill);
+		top = head.size();
+		used = 0;
+		open = true;
+	}
+	inline void close_page(void)
+	{
+		for (; used < room(); ++used)
+			out.newline();
+		foot.render(out, sep, fill);
+		open = false;
+	}
+
+public:
+	/** Create a paginator.
+	 *
+	 * @param os		an ostream object to output text into
+	 * @param lines		the number of lines on a page, at least 1
+	 * @param separator	a string to separate the columns with
+	 * @param filler	a character to fill the space between the last
+	 *              	character in a column on a given line and the separator
+	 */
+	inline paginator(std::ostream& os, std::size_t lines, const char *separator = " ", char filler = ' ')
+		: out{os}, budget{lines}, sep{separator}, fill{filler} {}
+	inline paginator(const paginator&) = delete;
+	inline ~paginator() { finish(); }
+
+	/** Set the columns repeated at the top of every page, starting with the next one.
+	 *
+	 * @return false, leaving the header as it was, if the header and the
+	 * footer would take the whole page
+	 */
+	inline bool header(const column *cols, std::size_t n)
+	{
+		next.assign(cols, n);
+		if (!fits(next.size(), foot.size()))
+			return false;
+		std::swap(head, next);
+		return true;
+	}
+	template <typename... Cols, internal::force_type<column, Cols...> = 0>
+	inline bool header(const Cols&... cols)
+	{
+		const std::array<column,sizeof...(cols)> c{ cols... };
+
+		return header(c.data(), c.size());
+	}
+
+	/** Set the columns repeated at the bottom of every page, starting with the
+	 * current one. If the rows already on the current page leave too little
+	 * room for the new footer, the page ends with the old footer instead.
+	 *
+	 * @return false, leaving the footer as it was, if the header and the
+	 * footer would take the whole page
+	 */
+	inline bool footer(const column *cols, std::size_t n)
+	{
+		next.assign(cols, n);
+		if (!fits(head.size(), next.size()))
+			return false;
+		if (open && top + used + next.size() > budget)
+			close_page();
+		std::swap(foot, next);
+		return true;
+	}
+	template <typename... Cols, internal::force_type<column, Cols...> = 0>
+	inline bool footer(const Cols&... cols)
+	{
+		const std::array<column,sizeof...(cols)> c{ cols... };
+
+		return footer(c.data(), c.size());
+	}
+
+	/** Output a row of the table, breaking the page before it if it does not fit. */
+	inline paginator& row(const column *cols, std::size_t n)
+	{
+		body.assign(cols, n);
+		if (open && used && used + body.size() > room() && body.size() <= room())
+			close_page();
+		for (std::size_t ln = 0, to; ln < body.size(); ln = to) {
+			if (open && used == room())
+				close_page();
+			if (!open)
+				open_page();
+			to = std::min(body.size(), ln + room() - used);
+			body.render(out, sep, fill, ln, to);
+			used += to - ln;
+		}
+		return *this;
+	}
+	template <typename... Cols, internal::force_type<column, Cols...> = 0>
+	inline paginator& row(const Cols&... cols)
+	{
+		const std::array<column,sizeof...(cols)> c{ cols... };
+
+		return row(c.data(), c.size());
+	}
+
+	/** Complete the last page with empty lines and the footer. */
+	inline void finish(void)
+	{
+		if (open)
+			close_page();
+	}
+};
+
+/** Output columns of text that are too wide for the screen in pages.
+ *
+ * Splits the columns into pages that are at most "total" characters wide and
+ * outputs each page as a table of its own, with an empty line in between.
+ * The first "keys" columns, e.g. names or identifiers, are repeated at the
+ * left of every page. The split is computed from the column widths alone,
+ * and every page is a pass over the same column texts, which are never
+ * copied.
+ *
+ * @param os		an ostream object to output text into
+ * @param total		the maximum width of a page, e.g. the terminal width
+ * @param keys		the number of leading columns to repeat on every page
+ * @param sep		a string to separate the columns with
+ * @param fill		a character to fill the space between the last
+ *            		character in a column on a given line and the separator
+ * @param cols		pointer to the first of "n" "column" structures
+ * @param n		the number of columns
+ *
+ * Example:
+ * @code
+ *
+ * 	std::vector<tabulator::column> cols{ {host, 12} };
+ * 	for (const auto& m : metrics)
+ * 		cols.emplace_back(m, 10);
+ * 	tabulator::tabulate_pages(std::cout, 80, 1, " | ", ' ', cols.data(), cols.size());
+ *
+ * @endcode
+ *
+ * @return Reference to the stream, so that it could be used later in the same
+ * expression that has called the function.
+ */
+inline std::ostream& tabulate_pages(std::ostream& os, std::size_t total, std::size_t keys, const char *sep, char fill,
+		const column *cols, std::size_t n)
+{
+	const std::size_t seplen = std::strlen(sep);
+	std::vector<column> page;
+	std::vector<internal::colstate> state;
+
+	keys = keys < n ? keys : n;
+	page.reserve(n);
+	state.reserve(n);
+	for (std::size_t from = keys, to = 0; to < n; from = to) {
+		to = internal::page_end(cols, n, keys, from, total, seplen);
+		page.clear();
+		for (std::size_t col = 0; col < keys; ++col)
+			page.push_back(cols[col]);
+		for (std::size_t col = from; col < to; ++col)
+			page.push_back(cols[col]);
+		state.assign(page.size(), internal::colstate{});
+		if (from != keys)
+			os << '\n';
+		internal::tabulate(os, sep, fill, page.data(), state.data(), page.size());
+	}
+
+	return os;
+}
+
+/** Output one or more columns of text that are too wide for the screen in pages.
+ *
+ * This is an overload of tabulate_pages(ostream&, size_t, size_t, const char*,
+ * char, const column*, size_t) for a fixed set of columns.
+ *
+ * Example:
+ * @code
+ *
+ * 	tabulator::tabulate_pages(std::cout, 80, 1, " | ", ' ',
+ * 			column{"host-1", 8}, column{cpu, 30},
+ * 			column{mem, 30}, column{disk, 30});
+ *
+ * @endcode
+ *
+ * @return Reference to the stream, so that it could be used later in the same
+ * expression that has called the function.
+ */
+template <typename... Cols, internal::force_type<column, Cols...> = 0>
+inline std::ostream& tabulate_pages(std::ostream& os, std::size_t total, std::size_t keys, const char *sep, char fill,
+		const Cols&... cols)
+{
+	const std::array<column,sizeof...(cols)> c{ cols... };
+
+	return tabulate_pages(os, total, keys, sep, fill, c.data(), c.size());
+}
+
+namespace internal {
+
+// The widths of the columns that lengths "len" go into, "rows" of them per
+// column, down the columns and then across; false if the columns and the
+// separators between them do not fit in "total" characters
+inline bool grid_widths(std::vector<size_t>& width, const std::vector<size_t>& len, size_t rows, size_t total,
+		size_t seplen)
+{
+	size_t used;
+
+	width.assign((len.size() + rows - 1) / rows, 0);
+	for (size_t i = 0; i < len.size(); ++i)
+		width[i / rows] = std::max(width[i / rows], len[i]);
+	used = (width.size() - 1) * seplen;
+	for (size_t w : width)
+		used += w;
+	return used <= total;
+}
+
+// The fewest rows a list of items goes into in more than one column, trying
+// each number of columns, from the most that items of the shortest length
+// could fill, down to two; 0 if none of them fits
+inline size_t grid_rows(std::vector<size_t>& width, const std::vector<size_t>& len, size_t shortest, size_t total,
+		size_t seplen)
+{
+	const size_t n = len.size(), most = shortest + seplen ? std::min(n, (total + seplen) / (shortest + seplen)) : n;
+
+	for (size_t cols = most, tried = 0; cols > 1; --cols) {
+		const size_t rows = (n + cols - 1) / cols;
+
+		if (rows != tried && grid_widths(width, len, rows, total, seplen))
+			return rows;
+		tried = rows;
+	}
+	return 0;
+}
+
+}
+
+/** Output a list of short strings in as many columns as fit, like "ls -C".
+ *
+ * The items go down the first column, then down the second one, and so on.
+ * Each column is as wide as its longest item, and the number of columns is
+ * the largest one for which the columns and the separators between them fit
+ * in "total" characters; if even two columns do not fit, the items are output
+ * one per line. Items of the shortest length, and the separators between
+ * them, bound the number of columns that may fit, and only the numbers up to
+ * that bound are tried, each in a single pass over the item lengths, so the
+ * memory taken beyond the lengths is that of the widths of the columns.
+ *
+ * Example:
+ * @code
+ *
+ * 	tabulator::tabulate_grid(std::cout, 80, "  ", ' ', file_names);
+ *
+ * @endcode
+ *
+ * @param os		an ostream object to output text into
+ * @param total		the maximum width of a line, e.g. the terminal width
+ * @param sep		a string to separate the columns with
+ * @param fill		a character to fill the space between an item and the
+ *            		separator after it
+ * @param items		the strings to output, none of them with a newline
+ *
+ * @return Reference to the stream, so that it could be used later in the same
+ * expression that has called the function.
+ */
+inline std::ostream& tabulate_grid(std::ostream& os, std::size_t total, const char *sep, char fill,
+		const std::vector<std::string>& items)
+{
+	const std::size_t n = items.size(), seplen = std::strlen(sep);
+	std::vector<std::size_t> len;
+	std::size_t shortest = ~std::size_t(0);
+
+	if (!n)
+		return os;
+	len.reserve(n);
+	for (const auto& item : items) {
+		len.push_back(item.size());
+		shortest = std::min(shortest, item.size());
+	}
+
+	std::vector<std::size_t> width;
+	std::size_t rows = internal::grid_rows(width, len, shortest, total, seplen);
+	internal::ostream_sink out{os};
+
+	if (!rows)
+		rows = n; // one item per line, no fill
+	for (std::size_t row = 0; row < rows; ++row) {
+		for (std::size_t col = 0, i = row; i < n; ++col, i += rows) {
+			out.write(items[i].data(), items[i].size());
+			if (i + rows < n)
+				internal::switch_col(out, items[i].size(), width[col], fill, sep, seplen);
+		}
+		out.newline();
+	}
+	return os;
+}
+
 }
 
 #endif /* TEST_TABULATOR_H_ */
@@ -0,0 +1,916 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef TABULATOR_CORE_H_
+#define TABULATOR_CORE_H_
+
+/* Layout core of the tabulator.
+ *
+ * This header has no dependency on iostreams or std::string, never allocates
+ * memory and never throws, so it can be used in freestanding, real-time and
+ * -fno-exceptions builds. It renders into a caller supplied buffer or into
+ * any "sink". tabulator.h builds the ostream interface on top of it.
+ */
+
+#include <cstddef>
+#include <cstring>
+
+#include <type_traits>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#endif
+
+namespace tabulator {
+
+/** Where a column clipped to a single line cuts its text off.
+ *
+ * "none" is the default: the text is wrapped into as many lines as needed.
+ * Otherwise the text is shown on one line, and if it does not fit, the part
+ * at the end, at the start or in the middle is replaced with "...". Middle
+ * truncation suits file paths, where both ends are usually informative.
+ */
+enum class ellipsis { none, end, start, middle };
+
+/** Where the lines of a column go when other columns of the row are taller. */
+enum class valign { top, middle, bottom };
+
+/** What a generated column shows on each line of its row.
+ *
+ * "lines" numbers every line, "rows" shows a number on the first line only,
+ * "marker" shows one text on the first line and another on the rest.
+ */
+enum class gutter { none, lines, rows, marker };
+
+/** A piece of a text that is stored in several non-contiguous buffers. */
+struct segment {
+	const char *p;
+	std::size_t n;
+};
+
+struct column {
+	const char * const p;
+	const std::size_t size;
+	const std::size_t width;
+	ellipsis trunc{ellipsis::none};
+	std::size_t maxlines{0};
+	const char *more{nullptr};
+	valign va{valign::top};
+	gutter gen{gutter::none};
+	std::size_t base{0};
+	const char *cont{nullptr};
+	const char *lead{""};
+	std::size_t leadlen{0};
+	const char *hang{""};
+	std::size_t hanglen{0};
+	const segment *segs{nullptr};
+	std::size_t nsegs{0};
+
+	/** A place in a segmented text: a segment and the index of its first
+	 * character. Walking the text from the place last looked at is cheap,
+	 * as layout moves through it almost sequentially. Every walk has its
+	 * own cursor, so a column is never written to and may be rendered by
+	 * several threads at once. */
+	struct cursor {
+		std::size_t seg{0};
+		std::size_t pos{0};
+	};
+
+	inline column(const char *s, std::size_t w) : p{s}, size{std::strlen(s)}, width{w} {}
+	inline column(const char *s, std::size_t n, std::size_t w) : p{s}, size{n}, width{w} {}
+	template <class S, class = decltype(static_cast<const S *>(nullptr)->c_str())>
+	inline column(const S& s, std::size_t w) : p{s.c_str()}, size{s.size()}, width{w} {}
+	/** Make a column of a text stored as a chain of "count" segments.
+	 *
+	 * The layout walks the segments as one text, words may span segment
+	 * boundaries, and nothing is copied or concatenated. The segments must
+	 * outlive the column.
+	 */
+	inline column(const segment *s, std::size_t count, std::size_t w)
+		: p{nullptr}, size{total(s, count)}, width{w}, segs{s}, nsegs{count} {}
+	inline column(const column&) = default;
+
+	/** Character "i" of the text, walking to it from "at". */
+	inline char at(std::size_t i, cursor& at) const
+	{
+		if (!segs)
+			return p[i];
+		locate(i, at);
+		return segs[at.seg].p[i - at.pos];
+	}
+
+	/** Character "i" of the text. */
+	inline char at(std::size_t i) const
+	{
+		cursor from;
+
+		return at(i, from);
+	}
+
+	/** Pointer to character "i" of the text, walking to it from "at"; "n"
+	 * receives how many characters from there on are contiguous in memory. */
+	inline const char *run(std::size_t i, std::size_t& n, cursor& at) const
+	{
+		if (!segs) {
+			n = size - i;
+			return p + i;
+		}
+		locate(i, at);
+		n = segs[at.seg].n - (i - at.pos);
+		return segs[at.seg].p + (i - at.pos);
+	}
+
+	/** A cursor at the last segment, to walk the text from its end. */
+	inline cursor last(void) const
+	{
+		cursor at;
+
+		if (segs && nsegs) {
+			at.seg = nsegs - 1;
+			at.pos = size - segs[at.seg].n;
+		}
+		return at;
+	}
+
+	static inline std::size_t total(const segment *s, std::size_t count)
+	{
+		std::size_t n = 0;
+
+		for (std::size_t i = 0; i < count; ++i)
+			n += s[i].n;
+		return n;
+	}
+
+	// Walk from the segment at a cursor to the one holding character i
+	inline void locate(std::size_t i, cursor& at) const
+	{
+		while (i < at.pos)
+			at.pos -= segs[--at.seg].n;
+		while (i >= at.pos + segs[at.seg].n)
+			at.pos += segs[at.seg++].n;
+	}
+
+	/** Clip the column to one line instead of wrapping it.
+	 *
+	 * Only O(width) characters of the text are looked at, however long
+	 * it is. Use the (text, length, width) constructor for very long
+	 * C strings to avoid the strlen() as well.
+	 *
+	 * Example:
+	 * @code
+	 *
+	 * 	tabulate(std::cout, " | ",
+	 * 			column{path, 24}.truncate(ellipsis::middle),
+	 * 			column{description, 40});
+	 *
+	 * @endcode
+	 *
+	 * @return Reference to this column, so that it could be passed on in the
+	 * same expression.
+	 */
+	inline column& truncate(ellipsis where) { trunc = where; return *this; }
+
+	/** Limit the number of lines the column may take.
+	 *
+	 * If the text needs more than "lines" lines, the last of them shows
+	 * "marker" instead, and the rest of the text is not laid out at all:
+	 * the cost of a column is bounded by its limit, not by its length.
+	 *
+	 * Example:
+	 * @code
+	 *
+	 * 	tabulate(std::cout, " | ",
+	 * 			column{name, 16},
+	 * 			column{stack_trace, 60}.limit(5, "[more...]"));
+	 *
+	 * @endcode
+	 *
+	 * @return Reference to this column, so that it could be passed on in the
+	 * same expression.
+	 */
+	inline column& limit(std::size_t lines, const char *marker = "...") { maxlines = lines; more = marker; return *this; }
+
+	/** Align the column vertically within the row.
+	 *
+	 * A row that has columns not aligned to the top is laid out in two
+	 * passes: the first one records where each line of each column is in
+	 * its text, the second emits the recorded lines at their place. Only
+	 * the ostream overloads of tabulate() do that; the buffer overload,
+	 * which never allocates memory, aligns all columns to the top.
+	 *
+	 * @return Reference to this column, so that it could be passed on in the
+	 * same expression.
+	 */
+	inline column& align(valign where) { va = where; return *this; }
+
+	/** Start every line of the column with a prefix.
+	 *
+	 * The first line starts with "first", the following ones with "rest",
+	 * e.g. "- " and "  " for a bullet list item with a hanging indent, or
+	 * "// " and "// " to reflow a comment. The prefixes take part of the
+	 * column width, so the text is wrapped to what remains.
+	 *
+	 * Example:
+	 * @code
+	 *
+	 * 	for (const auto& item : items)
+	 * 		tabulate(std::cout, column{item, 40}.prefix("- ", "  "));
+	 *
+	 * @endcode
+	 *
+	 * @return Reference to this column, so that it could be passed on in the
+	 * same expression.
+	 */
+	inline column& prefix(const char *first, const char *rest)
+	{
+		lead = first;
+		leadlen = std::strlen(first);
+		hang = rest;
+		hanglen = std::strlen(rest);
+		return *this;
+	}
+
+	/** Make a column that numbers the lines of its row.
+	 *
+	 * The text of a generated column is produced for each output line as
+	 * it is emitted, right-aligned to the column width, instead of being
+	 * stored in a string. A generated column never makes a row taller.
+	 *
+	 * Example:
+	 * @code
+	 *
+	 * 	tabulate(std::cout, " | ", column::numbers(1, 5), column{text, 72});
+	 *
+	 * @endcode
+	 *
+	 * @param first		the number of the first line
+	 * @param w		the width of the column
+	 */
+	static inline column numbers(std::size_t first, std::size_t w)
+	{
+		column c{"", 0, w};
+
+		c.gen = gutter::lines;
+		c.base = first;
+		return c;
+	}
+
+	/** Make a column that shows a row number on the first line of its row.
+	 *
+	 * @param row		the number to show
+	 * @param w		the width of the column
+	 */
+	static inline column index(std::size_t row, std::size_t w)
+	{
+		column c{"", 0, w};
+
+		c.gen = gutter::rows;
+		c.base = row;
+		return c;
+	}
+
+	/** Make a column that shows one text on the first line of its row and
+	 * another on each of the following lines, e.g. a wrap marker.
+	 *
+	 * The texts are UTF-8, and each code point is taken to be one column
+	 * wide, so that a marker such as "↳" is filled up to the width like a
+	 * single character.
+	 *
+	 * @param first		the text for the first line
+	 * @param rest		the text for the other lines
+	 * @param w		the width of the column
+	 */
+	static inline column marker(const char *first, const char *rest, std::size_t w)
+	{
+		column c{first, w};
+
+		c.gen = gutter::marker;
+		c.cont = rest;
+		return c;
+	}
+};
+
+/** Destination of the rendered text.
+ *
+ * The layout engine hands its output to a sink in blocks: runs of column
+ * text, runs of fill characters and line ends. Derive from it to send
+ * tables somewhere the library does not know about.
+ */
+struct sink {
+	virtual void write(const char *s, std::size_t n) = 0;
+	virtual void fill(char ch, std::size_t n) = 0;
+	virtual void newline(void) = 0;
+
+protected:
+	~sink() = default;
+};
+
+namespace internal {
+
+using std::enable_if;
+using std::is_same;
+using std::size_t;
+
+// Thanks to https://www.fluentcpp.com/2019/01/25/variadic-number-function-parameters-type/
+// and https://en.cppreference.com/w/cpp/experimental/conjunction#Example
+template<bool...> struct bool_pack{};
+template<class... Us>
+using conjunction = is_same<bool_pack<true,Us::value...>, bool_pack<Us::value...,true> >;
+
+template <class T, class... Ts>
+using force_type = typename enable_if<conjunction<is_same<T, Ts>...>::value, int>::type;
+
+struct colstate {
+	size_t cp{0}; // index in the whole column text
+	size_t lp{0}; // index in the currently emitted line
+	size_t ln{0}; // index of the currently emitted line
+	column::cursor at; // near cp, for segmented texts
+
+	inline char consume(const column& c) { return end(c) ? 0 : c.at(cp++, at); }
+	inline colstate& breakLine(void) { lp = 0; ++ln; return *this; }
+	inline bool linebreak(char ch, const column& c) const;
+	inline bool nextWordFits(const column& c) const;
+	inline bool end(const column& c) const { return c.size <= cp; }
+};
+
+inline bool isws(char ch)
+{
+	// Same as isblank() in the "C" locale, without pulling in <cctype>
+	return ch == ' ' || ch == '\t';
+}
+
+inline bool colstate::linebreak(char ch, const column& c) const
+{
+	// Line break: ch is \\n or (ws and next word cannot be emitted).
+	return ch == '\n' || (isws(ch) && !nextWordFits(c));
+}
+
+inline bool colstate::nextWordFits(const column& c) const
+{
+	const size_t colwidth = c.width;
+	column::cursor k = at;
+	size_t l = lp;
+
+	// Next word can be emitted: lp will be at most colwidth on next ws.
+	for (size_t i = cp; i < c.size && c.at(i, k) && l < colwidth; ++i, ++l)
+		if (isws(c.at(i, k)))
+			return true;
+
+	return l < colwidth;
+}
+
+inline void switch_col(sink& out, size_t lp, size_t colwidth, char fill, const char *sep, size_t seplen)
+{
+	const size_t inc = fill == '\t' ? 8 : 1;
+
+	// Switch to next column: emit fill up to colwidth, emit sep
+	if (lp < colwidth)
+		out.fill(fill, (colwidth - lp + inc - 1) / inc);
+	out.write(sep, seplen);
+}
+
+inline size_t next_line(colstate& state, const column& c)
+{
+	const size_t start = state.cp;
+
+	// Lay out a line: consume ch until a line break. The characters before
+	// the break are contiguous in the text: the line is [start, start + lp).
+	for (char ch = state.consume(c); !!ch && !state.linebreak(ch, c); ch = state.consume(c))
+		++state.lp;
+	return start;
+}
+
+inline size_t scan_fwd(const column& c, size_t from, size_t max)
+{
+	// Length of the run of at most max characters from "from" up to a newline
+	column::cursor at;
+	size_t i = from;
+	while (i < c.size && i - from < max && c.at(i, at) != '\n')
+		++i;
+	return i - from;
+}
+
+inline size_t scan_back(const column& c, size_t to, size_t max)
+{
+	// Length of the run of at most max characters before "to" back to a newline
+	column::cursor at = c.last();
+	size_t i = to;
+	while (i > 0 && to - i < max && c.at(i - 1, at) != '\n')
+		--i;
+	return to - i;
+}
+
+// A clipped line: "head" characters from the start of the text, "e" dots,
+// then "tail" characters that end at "end".
+struct clipping {
+	size_t head, e, tail, end;
+
+	inline size_t len(void) const { return head + e + tail; }
+};
+
+inline clipping clip(const column& c)
+{
+	const size_t w = c.width > c.leadlen ? c.width - c.leadlen : 0;
+	const size_t e = w > 3 ? 3 : 0;
+	column::cursor back = c.last();
+	const size_t size = c.size && c.at(c.size - 1, back) == '\n' ? c.size - 1 : c.size;
+	size_t head = 0, tail = 0;
+
+	// Look at no more than w + 1 characters from either end: that's enough
+	// to tell whether the text fits and to find what to show if it doesn't.
+	if (c.trunc == ellipsis::start)
+		tail = scan_back(c, size, w + 1);
+	else
+		head = scan_fwd(c, 0, w + 1);
+
+	if (head + tail == size && head + tail <= w)
+		return clipping{size, 0, 0, size};
+
+	if (c.trunc == ellipsis::end) {
+		head = head < w - e ? head : w - e;
+	} else if (c.trunc == ellipsis::start) {
+		tail = tail < w - e ? tail : w - e;
+	} else {
+		const size_t half = (w - e + 1) / 2;
+		head = head < half ? head : half;
+		tail = scan_back(c, size, w - e - half);
+	}
+	return clipping{head, e, tail, size};
+}
+
+// Position of a line of a column in its text, not counting the prefix of the
+// line. Positions that are never in a text stand for the lines that are not
+// taken from it verbatim: the overflow marker of a limited column, the line
+// of a clipped one, a line of a generated one, or no line at all, after the
+// end of the text.
+struct span {
+	size_t pos;
+	size_t len;
+};
+
+enum : size_t {
+	span_marker = ~size_t(0),
+	span_clipped = ~size_t(0) - 1,
+	span_generated = ~size_t(0) - 2,
+	span_none = ~size_t(0) - 3,
+};
+
+// The text of a generated column on a line of its row: "pad" spaces, then
+// "len" bytes at "text", which may point into the caller's buffer, taking
+// "cols" columns on the screen.
+struct generated {
+	size_t pad;
+	const char *text;
+	size_t len;
+	size_t cols;
+
+	inline size_t width(void) const { return pad + cols; }
+};
+
+// Columns a UTF-8 text takes on the screen, one per code point: bytes that
+// continue a code point are not counted
+inline size_t code_points(const char *s, size_t n)
+{
+	size_t cols = 0;
+
+	for (size_t i = 0; i < n; ++i)
+		cols += (static_cast<unsigned char>(s[i]) & 0xc0) != 0x80;
+	return cols;
+}
+
+inline generated marker_text(const char *s, size_t n)
+{
+	return generated{0, s, n, code_points(s, n)};
+}
+
+inline generated generate(const column& c, size_t ln, char (&buf)[20])
+{
+	if (c.gen == gutter::marker)
+		return ln ? marker_text(c.cont, std::strlen(c.cont)) : marker_text(c.p, c.size);
+	if (c.gen == gutter::rows && ln)
+		return generated{0, buf, 0, 0};
+
+	// Format the number right into the end of the buffer
+	size_t v = c.base + (c.gen == gutter::lines ? ln : 0);
+	size_t i = sizeof buf;
+	do
+		buf[--i] = static_cast<char>('0' + v % 10);
+	while (v /= 10);
+
+	const size_t len = sizeof buf - i;
+	return generated{c.width > len ? c.width - len : 0, buf + i, len, len};
+}
+
+inline bool is_generated(const column& c)
+{
+	return c.gen != gutter::none;
+}
+
+inline size_t prefix_len(const column& c, size_t ln)
+{
+	return ln ? c.hanglen : c.leadlen;
+}
+
+inline span next_span(colstate& state, const column& c)
+{
+	if (is_generated(c)) {
+		char buf[20];
+		state.lp = generate(c, state.ln, buf).width();
+		return span{span_generated, state.lp};
+	}
+
+	if (state.end(c))
+		return span{span_none, 0};
+
+	// The prefix comes first on the line, the text is laid out after it
+	const size_t pre = prefix_len(c, state.ln);
+
+	if (c.trunc != ellipsis::none) {
+		const size_t len = clip(c).len();
+		state.lp = pre + len;
+		state.cp = c.size;
+		return span{span_clipped, len};
+	}
+
+	state.lp = pre;
+	const size_t start = next_line(state, c);
+
+	// On the last allowed line, show the marker instead if text remains
+	if (c.maxlines && state.ln + 1 >= c.maxlines && !state.end(c)) {
+		const size_t len = std::strlen(c.more);
+		state.lp = pre + len;
+		state.cp = c.size;
+		return span{span_marker, len};
+	}
+	return span{start, state.lp - pre};
+}
+
+inline void write_text(sink& out, const column& c, size_t pos, size_t len, column::cursor& at)
+{
+	// One block per segment the characters are stored in
+	for (size_t n; len; pos += n, len -= n) {
+		const char *s = c.run(pos, n, at);
+		n = n < len ? n : len;
+		out.write(s, n);
+	}
+}
+
+// Offset of the first "m" (> 0) bytes of "p" equal to "needle", "n" if none.
+// Candidates are the places where both the first and the last byte of the
+// needle match, 16 of them tested at once where SSE2 is available; only
+// those are compared in full.
+inline size_t find_bytes(const char *p, size_t n, const char *needle, size_t m)
+{
+	if (m > n)
+		return n;
+
+	size_t i = 0;
+#if defined(__SSE2__) && defined(__GNUC__)
+	const __m128i first = _mm_set1_epi8(needle[0]);
+	const __m128i last = _mm_set1_epi8(needle[m - 1]);
+
+	for (; i + m + 15 <= n; i += 16) {
+		const __m128i bf = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+		const __m128i bl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i + m - 1));
+		unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, bf),
+				_mm_cmpeq_epi8(last, bl))));
+
+		for (; mask; mask &= mask - 1) {
+			const size_t at = i + static_cast<size_t>(__builtin_ctz(mask));
+			if (m < 3 || !std::memcmp(p + at + 1, needle + 1, m - 2))
+				return at;
+		}
+	}
+#endif
+	while (i + m <= n) {
+		const void *hit = std::memchr(p + i, needle[0], n - m + 1 - i);
+		if (!hit)
+			break;
+		i = static_cast<size_t>(static_cast<const char *>(hit) - p);
+		if (p[i + m - 1] == needle[m - 1] && !std::memcmp(p + i, needle, m))
+			return i;
+		++i;
+	}
+	return n;
+}
+
+// Position of the first match of "needle" in the text of a column that
+// starts in [from, to), "c.size" if none; segment by segment, with the
+// matches that straddle two segments compared character by character
+inline size_t find_text(const column& c, size_t from, size_t to, const char *needle, size_t m)
+{
+	column::cursor cur;
+
+	to = to < c.size ? to : c.size;
+	for (size_t n; from < to; from += n) {
+		const char *s = c.run(from, n, cur);
+		const size_t len = n < to - from + m - 1 ? n : to - from + m - 1;
+		const size_t inner = find_bytes(s, len, needle, m);
+
+		if (inner < len)
+			return from + inner;
+		for (size_t at = from + (n >= m ? n - m + 1 : 0); at < from + n && at < to && at + m <= c.size; ++at) {
+			column::cursor k_at = cur;
+			size_t k = 0;
+			while (k < m && c.at(at + k, k_at) == needle[k])
+				++k;
+			if (k == m)
+				return at;
+		}
+	}
+	return c.size;
+}
+
+// "at" is where the text was last looked at, e.g. by the layout of the line
+inline void emit_span(sink& out, const column& c, span s, size_t ln, column::cursor& at)
+{
+	if (s.pos == span_none)
+		return;
+
+	if (s.pos == span_generated) {
+		char buf[20];
+		const generated g = generate(c, ln, buf);
+		out.fill(' ', g.pad);
+		out.write(g.text, g.len);
+		return;
+	}
+
+	out.write(ln ? c.hang : c.lead, prefix_len(c, ln));
+	if (s.pos == span_marker) {
+		out.write(c.more, s.len);
+	} else if (s.pos == span_clipped) {
+		const clipping k = clip(c);
+		column::cursor back = c.last();
+
+		write_text(out, c, 0, k.head, at);
+		out.write("...", k.e);
+		write_text(out, c, k.end - k.tail, k.tail, back);
+	} else {
+		write_text(out, c, s.pos, s.len, at);
+	}
+}
+
+inline bool is_unconsumed(const colstate *state, const column *c, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		if (!is_generated(c[i]) && !state[i].end(c[i]))
+			return true;
+	return false;
+}
+
+inline bool is_top_aligned(const column *c, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		if (c[i].va != valign::top)
+			return false;
+	return true;
+}
+
+// The layout loop of the library: every tabulate() overload, whatever the
+// number of its columns or its destination, ends up here or, for columns
+// that are not aligned to the top, in render_line() of a laid out row.
+inline void render(sink& out, const char *sep, char fill, const column *c, colstate *state, size_t n)
+{
+	const size_t seplen = std::strlen(sep);
+
+	// Emit lines until all character pointers are at the end of their strings
+	for (bool unconsumed = is_unconsumed(state, c, n); unconsumed; unconsumed = is_unconsumed(state, c, n)) {
+		// Line emit: emit column characters then (if not last col, then switch to next column) then break line
+		for (size_t col = 0; col < n; ++col) {
+			const span line = next_span(state[col], c[col]);
+			column::cursor at = state[col].at;
+
+			emit_span(out, c[col], line, state[col].ln, at);
+			if ((col + 1) < n)
+				switch_col(out, state[col].lp, c[col].width, fill, sep, seplen);
+			state[col].breakLine();
+		}
+		out.newline();
+	}
+}
+
+// State to lay out the last "n" lines of a column from. The line after a
+// hard newline is laid out the same whatever comes before it, so the text is
+// walked back a paragraph at a time, each laid out on its own, until the
+// paragraphs hold enough lines; the text before them is never looked at.
+inline colstate tail(const column& c, size_t n)
+{
+	colstate state;
+	size_t lines = 0;
+
+	if (is_generated(c))
+		return state; // no lines of its own
+	if (c.trunc != ellipsis::none || c.maxlines) {
+		// A few lines at most, whatever the length of the text
+		for (colstate s; !s.end(c); s.breakLine(), ++lines)
+			next_span(s, c);
+	} else {
+		column::cursor at = c.last();
+
+		state.cp = c.size;
+		for (size_t end = c.size; lines < n && end; end = state.cp) {
+			size_t start = end - 1;
+			while (start && c.at(start - 1, at) != '\n')
+				--start;
+
+			colstate s;
+			s.cp = start;
+			s.ln = start ? 1 : 0; // only tells the first line from the others
+			s.at = at;
+			for (; s.cp < end; s.breakLine(), ++lines)
+				next_span(s, c);
+			state.cp = start;
+			state.ln = start ? 1 : 0;
+			state.at = at;
+		}
+	}
+
+	for (; lines > n; --lines, state.breakLine())
+		next_span(state, c);
+	return state;
+}
+
+inline size_t row_height(const size_t *lines, size_t n)
+{
+	size_t height = 0;
+
+	for (size_t col = 0; col < n; ++col)
+		height = lines[col] > height ? lines[col] : height;
+	return height;
+}
+
+// First line of the row a column of the given number of lines starts on
+inline size_t top_line(const column& c, size_t height, size_t lines)
+{
+	const size_t gap = height - lines;
+
+	return c.va == valign::bottom ? gap : c.va == valign::middle ? gap / 2 : 0;
+}
+
+// Emits line "ln" of a row that has already been laid out: "row" holds the
+// span of each column on that line, "lines" the number of lines of each
+// column and "height" that of the row. "at" holds a cursor for each column,
+// kept from line to line.
+inline void render_line(sink& out, const char *sep, size_t seplen, char fill, const column *c, size_t n,
+		const span *row, const size_t *lines, size_t height, size_t ln, column::cursor *at)
+{
+	for (size_t col = 0; col < n; ++col) {
+		size_t lp = 0;
+
+		if (is_generated(c[col])) {
+			colstate state;
+
+			state.ln = ln;
+			emit_span(out, c[col], next_span(state, c[col]), ln, at[col]);
+			lp = state.lp;
+		} else if (row[col].pos != span_none) {
+			const size_t cl = ln - top_line(c[col], height, lines[col]);
+
+			emit_span(out, c[col], row[col], cl, at[col]);
+			lp = prefix_len(c[col], cl) + row[col].len;
+		}
+		if ((col + 1) < n)
+			switch_col(out, lp, c[col].width, fill, sep, seplen);
+	}
+	out.newline();
+}
+
+// Horizontal paging: the first "keys" columns are repeated on every page,
+// the rest are laid out from "from" on while the page is at most "total"
+// characters wide. Returns the end of the page; every page gets at least
+// one column of its own, even if it is too wide.
+inline size_t page_end(const column *c, size_t n, size_t keys, size_t from, size_t total, size_t seplen)
+{
+	size_t w = 0;
+
+	for (size_t col = 0; col < keys && col < n; ++col)
+		w += c[col].width + seplen;
+	for (size_t col = from; col < n; ++col) {
+		w += c[col].width;
+		if (w > total && col > from)
+			return col;
+		w += seplen;
+	}
+	return n;
+}
+
+struct buffer_sink : sink {
+	char * const p;
+	const size_t size;
+	size_t n{0};
+
+	inline buffer_sink(char *buf, size_t sz) : p{buf}, size{sz} {}
+
+	// Keep counting past the end of the buffer so the caller learns the
+	// size it needs; always leave room for the terminating NUL.
+	inline void write(const char *s, size_t len) override
+	{
+		for (size_t i = 0; i < len; ++i, ++n)
+			if (n + 1 < size)
+				p[n] = s[i];
+	}
+	inline void fill(char ch, size_t len) override
+	{
+		for (size_t i = 0; i < len; ++i, ++n)
+			if (n + 1 < size)
+				p[n] = ch;
+	}
+	inline void newline(void) override { fill('\n', 1); }
+	inline void terminate(void) { if (size) p[n < size ? n : size - 1] = 0; }
+};
+
+}
+
+/** Output one or more columns of text into a character buffer.
+ *
+ * Does the same as tabulate(ostream&, const char*, char, Cols...), but places
+ * the text into a caller supplied buffer in the manner of snprintf(): at most
+ * "size" - 1 characters are written, followed by a terminating NUL. Neither
+ * allocates memory nor throws.
+ *
+ * @param buf		a buffer to output text into
+ * @param size		the size of "buf" in characters
+ * @param sep		a string to separate the columns with
+ * @param fill		a character to fill the space between the last
+ *            		character in a column on a given line and the separator
+ * @param cols		a variable number of "column" structures
+ *
+ * Example:
+ * @code
+ *
+ * 	#include "tabulator_core.h"
+ *
+ * 	char buf[128];
+ * 	tabulator::tabulate(buf, sizeof buf, " | ", ' ',
+ * 			tabulator::column{"abc def ghi", 6},
+ * 			tabulator::column{"123 4432 17 8989", 4});
+ *
+ * @endcode
+ *
+ * @return The length of the whole table, not counting the terminating NUL.
+ * If it is "size" or more, the output has been truncated.
+ */
+template <typename... Cols, internal::force_type<column, Cols...> = 0>
+inline std::size_t tabulate(char *buf, std::size_t size, const char *sep, char fill, const Cols&... cols)
+{
+	internal::colstate state[sizeof...(cols)];
+	const column c[] = { cols... };
+	internal::buffer_sink out{buf, size};
+
+	internal::render(out, sep, fill, c, state, sizeof...(cols));
+	out.terminate();
+	return out.n;
+}
+
+/** Find a string in a block of memory.
+ *
+ * This is the search that layout::find() runs over the text of columns,
+ * for callers that keep their text elsewhere, such as a mapped file. Only
+ * the places where both the first and the last byte of "needle" match are
+ * compared in full, 16 places at a time where SSE2 is available.
+ *
+ * @param p		the text to search
+ * @param n		the length of the text
+ * @param needle	the string to find
+ * @param m		the length of "needle", at least 1
+ *
+ * Example:
+ * @code
+ *
+ * 	const std::size_t at = tabulator::find_bytes(map, size, "ERROR", 5);
+ * 	if (at < size)
+ * 		show(map + at);
+ *
+ * @endcode
+ *
+ * @return The offset of the first match in the text, "n" if there is none.
+ */
+inline std::size_t find_bytes(const char *p, std::size_t n, const char *needle, std::size_t m)
+{
+	return internal::find_bytes(p, n, needle, m);
+}
+
+}
+
+#endif /* TABULATOR_CORE_H_ */
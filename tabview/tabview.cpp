@@ -0,0 +1,625 @@
+/*
+MIT License
+
+Copyright (c) 2019 Alexander Lukichev <alexander.lukichev@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+/* tabview: a pager for huge CSV, TSV and text files, built on the tabulator.
+ *
+ * The file is mapped into memory, rows are found on demand with a sparse
+ * index (the start of every 256th line), and only the rows on the screen
+ * are split into cells and laid out, so opening and scrolling a file of
+ * many gigabytes takes as long as for a small one. Jumping to the end
+ * scans back from it, and a row is numbered "?" until the rows before it
+ * have been counted; counting, like searching, goes on a few megabytes at a
+ * time between keystrokes.
+ *
+ * Build:	c++ -std=c++11 -O2 -o tabview tabview.cpp
+ * Usage:	tabview [-c | -t | -p] [-N] [-n] FILE
+ *
+ * 	-c	comma-separated values (the default for *.csv)
+ * 	-t	tab-separated values (the default for *.tsv)
+ * 	-p	plain text, a line per row (the default otherwise)
+ * 	-N	no header row: do not keep the first row on top
+ * 	-n	show row numbers
+ *
+ * Keys:	j k, arrows	scroll a row, or a column left and right (h l)
+ * 		space b, PgDn PgUp	scroll a screen
+ * 		g G	go to the first or the last row
+ * 		w	wrap cells instead of clipping them
+ * 		/ n	search forward, search again; any key stops a search
+ * 		q	quit
+ *
+ * Quoted CSV fields are shown without the quotes, but a newline inside
+ * one still ends the row.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "../tabulator/stream.h"
+
+namespace {
+
+using tabulator::column;
+using tabulator::ellipsis;
+
+volatile std::sig_atomic_t resized = 1;
+
+void on_winch(int)
+{
+	resized = 1;
+}
+
+class mapping {
+	void *map{MAP_FAILED};
+
+public:
+	const char *p{nullptr};
+	std::size_t size{0};
+
+	explicit mapping(const char *path)
+	{
+		const int fd = ::open(path, O_RDONLY);
+		struct stat st;
+
+		if (fd < 0)
+			return;
+		if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+			map = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+			if (map != MAP_FAILED) {
+				::madvise(map, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+				p = static_cast<const char *>(map);
+				size = static_cast<std::size_t>(st.st_size);
+			}
+		} else if (::fstat(fd, &st) == 0) {
+			p = "";
+		}
+		::close(fd);
+	}
+	mapping(const mapping&) = delete;
+	~mapping()
+	{
+		if (map != MAP_FAILED)
+			::munmap(map, size);
+	}
+};
+
+// Sparse index of the lines of a text: the start of every 256th line,
+// extended as far as it has been asked for.
+class line_index {
+	enum { every = 256 };
+
+	const char * const p;
+	const std::size_t size;
+	std::vector<std::size_t> marks;
+	std::size_t known{0}; // lines found so far
+	std::size_t pos{0};   // where the next one starts
+
+	std::size_t skip(std::size_t from, std::size_t lines) const
+	{
+		for (; lines && from < size; --lines) {
+			const void *nl = std::memchr(p + from, '\n', size - from);
+			from = nl ? static_cast<std::size_t>(static_cast<const char *>(nl) - p) + 1 : size;
+		}
+		return from;
+	}
+
+	// Index lines until "row" is known or the text ends, or until a line
+	// starts after "offset"
+	void extend(std::size_t row, std::size_t offset = ~std::size_t(0))
+	{
+		while (known <= row && pos < size && pos <= offset) {
+			if (known % every == 0)
+				marks.push_back(pos);
+			pos = skip(pos, 1);
+			++known;
+		}
+	}
+
+public:
+	line_index(const char *text, std::size_t n) : p{text}, size{n} {}
+
+	bool exists(std::size_t row)
+	{
+		extend(row);
+		return row < known;
+	}
+
+	// Index about "bytes" more of the text
+	void advance(std::size_t bytes)
+	{
+		extend(~std::size_t(0), pos + bytes);
+	}
+
+	// Where the lines indexed so far end
+	std::size_t indexed(void) const { return pos; }
+
+	std::size_t end(std::size_t start) const
+	{
+		const void *nl = std::memchr(p + start, '\n', size - start);
+		return nl ? static_cast<std::size_t>(static_cast<const char *>(nl) - p) : size;
+	}
+
+	// The row the character at "offset" is in
+	std::size_t row_of(std::size_t offset)
+	{
+		extend(~std::size_t(0), offset);
+
+		const std::size_t k = static_cast<std::size_t>(std::upper_bound(marks.begin(), marks.end(), offset) - marks.begin()) - 1;
+		std::size_t row = k * every;
+		for (std::size_t at = marks[k]; (at = skip(at, 1)) <= offset && at < size; )
+			++row;
+		return row;
+	}
+};
+
+struct cell {
+	const char *p;
+	std::size_t n;
+};
+
+// Splits a row into cells, without copying
+void split(const char *p, std::size_t n, char delim, std::vector<cell>& cells)
+{
+	cells.clear();
+	if (n && p[n - 1] == '\r')
+		--n;
+	if (!delim) {
+		cells.push_back(cell{p, n});
+		return;
+	}
+	for (std::size_t i = 0; i <= n; ) {
+		std::size_t j = i;
+
+		if (delim == ',' && i < n && p[i] == '"') {
+			// Quoted field: up to the closing quote that is not doubled
+			for (j = i + 1; j < n && !(p[j] == '"' && (j + 1 == n || p[j + 1] != '"')); j += p[j] == '"' ? 2 : 1)
+				;
+			cells.push_back(cell{p + i + 1, (j < n ? j : n) - i - 1});
+			for (; j < n && p[j] != delim; ++j)
+				;
+		} else {
+			for (; j < n && p[j] != delim; ++j)
+				;
+			cells.push_back(cell{p + i, j - i});
+		}
+		i = j + 1;
+	}
+}
+
+// Collects the screen in a string, clipping every line to the terminal
+// width and replacing control characters, which must not reach the terminal
+struct screen_sink : tabulator::sink {
+	std::string text;
+	std::size_t width{80};
+	std::size_t x{0};
+
+	void write(const char *s, std::size_t n) override
+	{
+		for (std::size_t i = 0; i < n && x < width; ++i, ++x)
+			text += static_cast<unsigned char>(s[i]) < 0x20 || s[i] == 0x7f ? ' ' : s[i];
+	}
+	void fill(char ch, std::size_t n) override
+	{
+		n = std::min(n, width - std::min(x, width));
+		text.append(n, ch);
+		x += n;
+	}
+	void newline(void) override
+	{
+		text += "\x1b[K\r\n";
+		x = 0;
+	}
+};
+
+class terminal {
+	struct termios saved;
+
+public:
+	terminal()
+	{
+		struct termios raw;
+
+		::tcgetattr(0, &saved);
+		raw = saved;
+		raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO | ISIG | IEXTEN);
+		raw.c_iflag &= ~static_cast<tcflag_t>(IXON | ICRNL);
+		raw.c_cc[VMIN] = 0;
+		raw.c_cc[VTIME] = 1;
+		::tcsetattr(0, TCSAFLUSH, &raw);
+		put("\x1b[?1049h\x1b[?25l");
+	}
+	~terminal()
+	{
+		put("\x1b[?25h\x1b[?1049l");
+		::tcsetattr(0, TCSAFLUSH, &saved);
+	}
+
+	static void put(const std::string& s)
+	{
+		for (std::size_t done = 0; done < s.size(); ) {
+			const ssize_t n = ::write(1, s.data() + done, s.size() - done);
+			if (n <= 0)
+				break;
+			done += static_cast<std::size_t>(n);
+		}
+	}
+
+	static void size(std::size_t& rows, std::size_t& cols)
+	{
+		struct winsize ws;
+
+		if (::ioctl(1, TIOCGWINSZ, &ws) == 0 && ws.ws_row && ws.ws_col) {
+			rows = ws.ws_row;
+			cols = ws.ws_col;
+		}
+	}
+
+	// A key, with arrows and pages as single codes; 0 if none came within
+	// "wait" milliseconds
+	static int key(int wait)
+	{
+		struct pollfd in{0, POLLIN, 0};
+		unsigned char c[4];
+
+		if (::poll(&in, 1, wait) <= 0 || ::read(0, c, 1) <= 0)
+			return 0;
+		if (c[0] != 0x1b || ::read(0, c + 1, 1) <= 0 || c[1] != '[' || ::read(0, c + 2, 1) <= 0)
+			return c[0];
+		switch (c[2]) {
+		case 'A': return 'k';
+		case 'B': return 'j';
+		case 'C': return 'l';
+		case 'D': return 'h';
+		case '5': return ::read(0, c + 3, 1) > 0 && c[3] == '~' ? 'b' : 0;
+		case '6': return ::read(0, c + 3, 1) > 0 && c[3] == '~' ? ' ' : 0;
+		default: return 0;
+		}
+	}
+};
+
+class viewer {
+	// Work between keystrokes goes in steps of this many bytes of the file
+	enum : std::size_t { none = ~std::size_t(0), step = 16 << 20 };
+
+	const mapping& file;
+	const std::string name;
+	const char delim;
+	line_index index;
+	const bool header;
+	const bool numbers;
+	std::vector<std::size_t> widths;
+	std::vector<cell> cells;
+	std::vector<column> cols;
+	std::size_t rows{24}, width{80};
+	std::size_t top{0};  // first row on the screen, not counting the header
+	std::size_t at{0};   // where that row starts
+	bool counted{true};  // whether "top" is known: rows are counted lazily
+	std::size_t left{0}; // first column on the screen
+	bool wrap{false};
+	std::string query, status;
+	std::size_t searched{none}; // where a search in progress goes on from
+
+	std::size_t first(void) const { return header ? 1 : 0; }
+
+	// Where the row that "off" is in starts
+	std::size_t start(std::size_t off) const
+	{
+		while (off && file.p[off - 1] != '\n')
+			--off;
+		return off;
+	}
+
+	// Where the row after the one at "off" starts, the end if there is none
+	std::size_t next(std::size_t off) const { return std::min(file.size, index.end(off) + 1); }
+
+	// Where the first row under the header starts
+	std::size_t home(void) const { return header ? next(0) : 0; }
+
+	// Where the last row starts: found from the end, as the rows before it
+	// may not have been looked at yet
+	std::size_t last(void) const
+	{
+		const std::size_t end = file.size && file.p[file.size - 1] == '\n' ? file.size - 1 : file.size;
+
+		return std::max(start(end), home());
+	}
+
+	// Puts the row at "off" on top of the screen. Its number is known if the
+	// index has got that far; otherwise work() counts up to it later.
+	void go(std::size_t off)
+	{
+		at = off;
+		counted = off <= home() || off < index.indexed() || index.indexed() == file.size;
+		if (counted)
+			top = off <= home() ? 0 : index.row_of(off) - first();
+	}
+
+	void down(void)
+	{
+		if (next(at) < file.size) {
+			at = next(at);
+			++top;
+		}
+	}
+
+	void up(void)
+	{
+		if (at > home()) {
+			at = start(at - 1);
+			--top;
+		}
+	}
+
+	// Column widths from the lengths of the cells of the first rows
+	void measure(void)
+	{
+		std::vector<tabulator::length_sketch> sketches;
+
+		for (std::size_t row = 0, off = 0; row < 1000 && index.exists(row); ++row, off = index.end(off) + 1) {
+			split(file.p + off, index.end(off) - off, delim, cells);
+			while (sketches.size() < cells.size())
+				sketches.emplace_back(delim ? 40 : 4096);
+			for (std::size_t i = 0; i < cells.size(); ++i)
+				sketches[i].add(cells[i].n);
+		}
+		for (const auto& s : sketches)
+			widths.push_back(std::max<std::size_t>(1, s.quantile(delim ? 0.9 : 1.0)));
+		if (widths.empty())
+			widths.push_back(1);
+	}
+
+	// Lays out the row at "off", numbered "row" unless that is "none", of
+	// the visible columns and emits up to "room" lines of it
+	std::size_t draw_row(screen_sink& out, std::size_t off, std::size_t row, std::size_t room)
+	{
+		const std::size_t digits = std::to_string(counted ? top + rows : rows).size();
+		std::size_t used = numbers ? digits + 3 : 0;
+
+		split(file.p + off, index.end(off) - off, delim, cells);
+		cols.clear();
+		if (numbers)
+			cols.push_back(row == none || (header && off == 0) ? column{"", 0, digits} : column::index(row + 1 - first(), digits));
+		for (std::size_t i = left; i < widths.size() && (i == left || used + widths[i] <= width); used += widths[i++] + 3) {
+			const std::size_t w = std::min(widths[i], width > used + 1 ? width - used : 1);
+			column c = i < cells.size() ? column{cells[i].p, cells[i].n, w} : column{"", 0, w};
+			cols.push_back(wrap ? c : c.truncate(ellipsis::end));
+		}
+
+		const tabulator::layout row_layout{cols.data(), cols.size()};
+		const std::size_t lines = std::max<std::size_t>(1, std::min(room, row_layout.size()));
+		for (std::size_t ln = 0; ln < lines; ++ln) {
+			if (ln < row_layout.size())
+				row_layout.render_line(out, " | ", ' ', ln);
+			else
+				out.newline();
+		}
+		return lines;
+	}
+
+	void draw(void)
+	{
+		screen_sink out;
+		std::size_t y = 0;
+
+		out.width = width;
+		out.text = "\x1b[H";
+		if (header && file.size) {
+			y += draw_row(out, 0, 0, 1);
+			out.fill('-', width);
+			out.newline();
+			++y;
+		}
+		for (std::size_t row = top + first(), off = at; y + 1 < rows && off < file.size; ++row, off = next(off))
+			y += draw_row(out, off, counted ? row : none, rows - 1 - y);
+		for (; y + 1 < rows; ++y) {
+			out.write("~", 1);
+			out.newline();
+		}
+
+		const std::string where = name + "  row " + (counted ? std::to_string(top + 1) : "?") + ", column "
+				+ std::to_string(left + 1) + (wrap ? "  [wrap]" : "");
+		out.text += "\x1b[7m";
+		out.write(status.empty() ? where.c_str() : status.c_str(), status.empty() ? where.size() : status.size());
+		out.fill(' ', width);
+		out.text += "\x1b[0m";
+		terminal::put(out.text);
+	}
+
+	void prompt(void)
+	{
+		std::string q;
+
+		for (;;) {
+			status = "/" + q;
+			draw();
+			const int k = terminal::key(100);
+			if (k == '\r' || k == '\n')
+				break;
+			if (k == 0x1b) {
+				status.clear();
+				return;
+			}
+			if ((k == 0x7f || k == 8) && !q.empty())
+				q.pop_back();
+			else if (k >= 0x20 && k < 0x7f)
+				q += static_cast<char>(k);
+		}
+		query = q;
+		find();
+	}
+
+	// Starts a search from the row after the top one; work() carries it out
+	void find(void)
+	{
+		status.clear();
+		if (query.empty())
+			return;
+		searched = next(at);
+		status = "Searching: " + query + "  (any key stops)";
+	}
+
+	bool busy(void) const { return searched != none || !counted; }
+
+	// A step of the search or of counting the rows, between keystrokes;
+	// true if the screen has to be drawn again
+	bool work(void)
+	{
+		if (searched != none) {
+			const std::size_t end = std::min(file.size, searched + step + query.size() - 1);
+			const std::size_t hit = searched + tabulator::find_bytes(file.p + searched, end - searched,
+					query.data(), query.size());
+
+			if (hit < end) {
+				searched = none;
+				status.clear();
+				go(start(hit));
+				return true;
+			}
+			if (end == file.size) {
+				searched = none;
+				status = "Pattern not found: " + query;
+				return true;
+			}
+			searched += step;
+			return false;
+		}
+		if (!counted) {
+			index.advance(step);
+			go(at);
+			return counted;
+		}
+		return false;
+	}
+
+public:
+	viewer(const mapping& m, const char *path, char d, bool head, bool num)
+		: file(m), name{path}, delim{d}, index{m.p, m.size}, header{head}, numbers{num}
+	{
+		measure();
+		at = home();
+	}
+
+	void run(void)
+	{
+		for (;;) {
+			if (resized) {
+				resized = 0;
+				terminal::size(rows, width);
+			}
+			draw();
+
+			int k;
+			while (!(k = terminal::key(busy() ? 0 : 100)) && !resized)
+				if (work())
+					break;
+			if (!k)
+				continue;
+			status.clear();
+			if (searched != none) {
+				searched = none; // the key only stops the search
+				status = "Search stopped";
+				continue;
+			}
+
+			const std::size_t page = rows > 3 + first() ? rows - 2 - 2 * first() : 1;
+			switch (k) {
+			case 'q': return;
+			case 'j': down(); break;
+			case 'k': up(); break;
+			case ' ': case 'f':
+				for (std::size_t i = 0; i < page; ++i)
+					down();
+				break;
+			case 'b':
+				for (std::size_t i = 0; i < page; ++i)
+					up();
+				break;
+			case 'g': go(home()); break;
+			case 'G': go(last()); break;
+			case 'l': if (left + 1 < widths.size()) ++left; break;
+			case 'h': if (left) --left; break;
+			case 'w': wrap = !wrap; break;
+			case '/': prompt(); break;
+			case 'n': find(); break;
+			}
+		}
+	}
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+	int mode = 0;
+	bool header = true, numbers = false;
+	int opt;
+
+	while ((opt = ::getopt(argc, argv, "ctpNn")) != -1) {
+		switch (opt) {
+		case 'c': case 't': case 'p': mode = opt; break;
+		case 'N': header = false; break;
+		case 'n': numbers = true; break;
+		default:
+			std::fprintf(stderr, "usage: %s [-c | -t | -p] [-N] [-n] FILE\n", argv[0]);
+			return 2;
+		}
+	}
+	if (optind + 1 != argc) {
+		std::fprintf(stderr, "usage: %s [-c | -t | -p] [-N] [-n] FILE\n", argv[0]);
+		return 2;
+	}
+
+	const char *path = argv[optind];
+	const std::size_t len = std::strlen(path);
+	if (!mode)
+		mode = len > 4 && !std::strcmp(path + len - 4, ".csv") ? 'c' : len > 4 && !std::strcmp(path + len - 4, ".tsv") ? 't' : 'p';
+
+	const mapping file{path};
+	if (!file.p) {
+		std::perror(path);
+		return 1;
+	}
+	if (!::isatty(0) || !::isatty(1)) {
+		std::fprintf(stderr, "%s: not a terminal\n", argv[0]);
+		return 1;
+	}
+
+	std::signal(SIGWINCH, on_winch);
+	viewer v{file, path, mode == 'c' ? ',' : mode == 't' ? '\t' : '\0', header && mode != 'p', numbers};
+	terminal term;
+	v.run();
+	return 0;
+}